@@ -21,6 +21,10 @@ extern "C" {
 #define INVERT_OFF      0
 #define BRIGHTNESS_OFF  100 // means 100/1=1
 
+#define VIEW_BOTH       -1
+#define VIEW_LEFT       0
+#define VIEW_RIGHT      1
+
 // Must be implemented in the host app
 void platform_set_window_title(const char* title);
 void platform_clear_buffer(byte color);
@@ -31,6 +35,9 @@ void platform_set_pixel(int x, int y, byte color, int brightness);
 // Only color, but invert flag, to differentiate between text (invert=true) and the rest
 void platform_draw_line(int x1, int y1, int x2, int y2, byte color, int invert);
 
+// Stereo output (3D Imager), the lines until the next call are seen by one eye only
+void platform_set_view(int view);
+
 byte platform_get_input(byte code);
 byte platform_get_control_state(byte code);
 
@@ -38,6 +45,9 @@ const char* platform_resource_file_path(const char* filename, const char* extens
 
 double platform_get_ms(void);
 
+// Current internal render size, drawing calls are in this space (can change per frame)
+void platform_get_render_size(int* width, int* height);
+
 void platform_on_init(const char* name, int width, int height);
 void platform_on_frame(float deltaTime);
 
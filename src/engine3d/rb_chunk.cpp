@@ -0,0 +1,210 @@
+//
+//  rb_chunk.cpp
+//  3d wireframe game engine: static geometry chunks
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_chunk.hpp"
+#include "rb_object.hpp"
+#include "rb_log.h"
+
+#include <algorithm>
+
+#define CHUNK_EPSILON   0.0001f
+
+// Face rectangle in the two axes perpendicular to the face normal
+struct ChunkRect {
+    float u0, v0;
+    float u1, v1;
+};
+
+static float& VecAxis(Vec3D& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// MARK: - Building
+
+void StaticChunk::Clear() {
+    _boxes.clear();
+    _bounds.Clear();
+    _mesh.tris.clear();
+    _mesh.radius = -1.0f;
+}
+
+void StaticChunk::AddBox(Vec3D pos, Vec3D scale, byte color) {
+    ChunkBox box;
+    box.min = Vec3DMakef(std::min(pos.x, pos.x + scale.x), std::min(pos.y, pos.y + scale.y), std::min(pos.z, pos.z + scale.z));
+    box.max = Vec3DMakef(std::max(pos.x, pos.x + scale.x), std::max(pos.y, pos.y + scale.y), std::max(pos.z, pos.z + scale.z));
+    box.color = color;
+    box.flat = false;
+
+    Vec3D size = Vec3DSub(box.max, box.min);
+    float area = std::max(size.x * size.y, std::max(size.y * size.z, size.z * size.x));
+    box.occluder = area >= CHUNK_OCCLUDER_AREA;
+
+    _boxes.push_back(box);
+}
+
+// Same as GAME_OBJECT_TYPE_RECTANGLE, only the bottom face of the box
+void StaticChunk::AddRectangle(Vec3D pos, Vec3D scale, byte color) {
+    AddBox(pos, scale, color);
+    _boxes.back().flat = true;
+    _boxes.back().occluder = false;
+}
+
+// Merge all boxes into the mesh, faces covered by a touching box facing the other way are removed
+void StaticChunk::Build() {
+    _mesh.tris.clear();
+    _mesh.triangleColors = true;
+
+    if (_boxes.empty()) {
+        _origin = Vec3DMakeZero();
+        _size = Vec3DMakeZero();
+        _mesh.UpdateBounds();
+        return;
+    }
+
+    Vec3D min = _boxes[0].min;
+    Vec3D max = _boxes[0].max;
+
+    for (auto &box : _boxes) {
+        min.x = std::min(min.x, box.min.x); max.x = std::max(max.x, box.max.x);
+        min.y = std::min(min.y, box.min.y); max.y = std::max(max.y, box.max.y);
+        min.z = std::min(min.z, box.min.z); max.z = std::max(max.z, box.max.z);
+    }
+
+    // Geometry is relative to the minimum corner, which becomes the position of the game object
+    _origin = min;
+    _size = Vec3DSub(max, min);
+
+    _bounds.Clear();
+
+    for (auto &box : _boxes) {
+        box.min = Vec3DSub(box.min, _origin);
+        box.max = Vec3DSub(box.max, _origin);
+        _bounds.Add(box.min, box.max);
+    }
+
+    for (auto &box : _boxes) {
+        for (int axis = 0; axis < 3; axis++) {
+            for (int side = 0; side < 2; side++) {
+                if (box.flat && !(axis == 1 && side == 0)) {
+                    continue;
+                }
+
+                AddFace(box, axis, side);
+            }
+        }
+    }
+
+    _mesh.UpdateBounds();
+    _mesh.UpdateNormals();
+
+    RBLOG_NUM1("StaticChunk: Build (# of tris)", _mesh.tris.size());
+}
+
+void StaticChunk::AddFace(ChunkBox& box, int axis, int side) {
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+    float plane = side ? VecAxis(box.max, axis) : VecAxis(box.min, axis);
+
+    std::vector<ChunkRect> rects;
+    rects.push_back({ VecAxis(box.min, u), VecAxis(box.min, v), VecAxis(box.max, u), VecAxis(box.max, v) });
+
+    for (auto &other : _boxes) {
+        if (&other == &box || rects.empty()) {
+            continue;
+        }
+
+        // Only the opposite face of the other box can cover this one
+        if (other.flat && !(axis == 1 && side == 1)) {
+            continue;
+        }
+
+        float otherPlane = side ? VecAxis(other.min, axis) : VecAxis(other.max, axis);
+        if (fabsf(otherPlane - plane) > CHUNK_EPSILON) {
+            continue;
+        }
+
+        ChunkRect cover = { VecAxis(other.min, u), VecAxis(other.min, v), VecAxis(other.max, u), VecAxis(other.max, v) };
+        std::vector<ChunkRect> remaining;
+
+        // Subtract the covered part, this leaves up to four rectangles
+        for (auto &r : rects) {
+            if (cover.u0 >= r.u1 || cover.u1 <= r.u0 || cover.v0 >= r.v1 || cover.v1 <= r.v0) {
+                remaining.push_back(r);
+                continue;
+            }
+
+            float u0 = std::max(r.u0, cover.u0);
+            float u1 = std::min(r.u1, cover.u1);
+
+            if (cover.u0 > r.u0) remaining.push_back({ r.u0, r.v0, cover.u0, r.v1 });
+            if (cover.u1 < r.u1) remaining.push_back({ cover.u1, r.v0, r.u1, r.v1 });
+            if (cover.v0 > r.v0) remaining.push_back({ u0, r.v0, u1, cover.v0 });
+            if (cover.v1 < r.v1) remaining.push_back({ u0, cover.v1, u1, r.v1 });
+        }
+
+        rects.swap(remaining);
+    }
+
+    for (auto &r : rects) {
+        AddQuad(axis, plane, side ? 1.0f : -1.0f, r.u0, r.v0, r.u1, r.v1, box.color);
+    }
+}
+
+// Two triangles split like the faces of a cube, wound so that the normal points along side
+void StaticChunk::AddQuad(int axis, float plane, float side, float u0, float v0, float u1, float v1, byte color) {
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+
+    // Degenerated faces of boxes without volume
+    if (u1 - u0 <= CHUNK_EPSILON || v1 - v0 <= CHUNK_EPSILON) {
+        return;
+    }
+
+    Vec3D corners[4];
+    float uv[4][2] = { { u0, v0 }, { u0, v1 }, { u1, v1 }, { u1, v0 } };
+
+    for (int i = 0; i < 4; i++) {
+        VecAxis(corners[i], axis) = plane;
+        VecAxis(corners[i], u) = uv[i][0];
+        VecAxis(corners[i], v) = uv[i][1];
+    }
+
+    Vec3D line1 = Vec3DSub(corners[1], corners[0]);
+    Vec3D line2 = Vec3DSub(corners[2], corners[0]);
+    Vec3D normal = Vec3DCrossProduct(line1, line2);
+
+    if (VecAxis(normal, axis) * side < 0.0f) {
+        std::swap(corners[1], corners[3]);
+    }
+
+    Triangle tri1(corners[0], corners[1], corners[2]);
+    Triangle tri2(corners[0], corners[2], corners[3]);
+    tri1.color = color;
+    tri2.color = color;
+
+    _mesh.tris.push_back(tri1);
+    _mesh.tris.push_back(tri2);
+}
+
+// MARK: - Collision
+
+// The chunk bounds enclose empty space, test the object against the boxes in batches
+bool StaticChunk::IsColliding(GameObject& object, Vec3D& pos) {
+    Vec3D min, max;
+    object.GetBounds(min, max);
+    min = Vec3DSub(min, pos);
+    max = Vec3DSub(max, pos);
+
+    for (int start = 0; start < _bounds.GetCount(); start += COLLISION_BATCH) {
+        if (OverlapBoxes(min, max, _bounds, start) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,67 @@
+//
+//  rb_chunk.hpp
+//  3d wireframe game engine: static geometry chunks
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_mesh.hpp"
+#include "rb_math.hpp"
+#include "rb_collision.hpp"
+
+#include <vector>
+
+// Number of chunks the engine recycles, must cover all chunks visible at the same time
+#define CHUNK_RING_SIZE     8
+
+// Boxes with a face of at least this area (world units) hide what is behind them, see GameEngine::BuildOcclusion()
+#define CHUNK_OCCLUDER_AREA 16.0f
+
+class GameObject;
+
+// MARK: - Chunk data
+
+// Axis aligned box of a chunk, relative to the chunk position after Build()
+struct ChunkBox {
+    Vec3D min;
+    Vec3D max;
+    byte color;
+    bool flat;              // Rectangle, only the bottom face is drawn
+    bool occluder;          // Large enough to be used for occlusion culling
+};
+
+// Static geometry merged into one mesh, culled, transformed and collision tested as one object
+class StaticChunk {
+public:
+    StaticChunk() {}
+
+    void Clear();
+    void AddBox(Vec3D pos, Vec3D scale, byte color);
+    void AddRectangle(Vec3D pos, Vec3D scale, byte color);
+    void Build();
+
+    bool IsEmpty() { return _boxes.empty(); }
+    bool IsColliding(GameObject& object, Vec3D& pos);
+
+    std::vector<ChunkBox>& GetBoxes() { return _boxes; }
+    Mesh* GetMesh() { return &_mesh; }
+    Vec3D& GetOrigin() { return _origin; }
+    Vec3D& GetSize() { return _size; }
+    GameObject* GetGameObject() { return _object; }
+    void SetGameObject(GameObject* object) { _object = object; }
+
+private:
+    void AddFace(ChunkBox& box, int axis, int side);
+    void AddQuad(int axis, float plane, float side, float u0, float v0, float u1, float v1, byte color);
+
+private:
+    std::vector<ChunkBox> _boxes;
+    BoxArray _bounds;       // Same boxes for the collision test
+    Mesh _mesh;
+    Vec3D _origin;          // Minimum corner of all boxes in world space
+    Vec3D _size;
+    GameObject* _object = nullptr;
+};
@@ -0,0 +1,318 @@
+//
+//  rb_collision.cpp
+//  3d wireframe game engine: collision detection
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_collision.hpp"
+#include "rb_object.hpp"
+#include "rb_log.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLLISION_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COLLISION_NEON
+#endif
+
+// Nearly sorted lists, each entry moves only a few places
+static void SortByMinZ(std::vector<CollisionEntry>& entries) {
+    for (size_t i = 1; i < entries.size(); i++) {
+        CollisionEntry entry = entries[i];
+        size_t j = i;
+
+        while (j > 0 && entries[j - 1].min.z > entry.min.z) {
+            entries[j] = entries[j - 1];
+            j--;
+        }
+
+        entries[j] = entry;
+    }
+}
+
+// MARK: - Box arrays
+
+void BoxArray::Clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void BoxArray::Add(Vec3D& min, Vec3D& max) {
+    minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+    maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+// The last box takes the place of the removed one
+void BoxArray::Remove(int n) {
+    minX[n] = minX.back(); minY[n] = minY.back(); minZ[n] = minZ.back();
+    maxX[n] = maxX.back(); maxY[n] = maxY.back(); maxZ[n] = maxZ.back();
+    minX.pop_back(); minY.pop_back(); minZ.pop_back();
+    maxX.pop_back(); maxY.pop_back(); maxZ.pop_back();
+}
+
+// One box against up to COLLISION_BATCH boxes from start, bit n is set if box start + n overlaps.
+// Touching boxes overlap, like GameObject::IsColliding(). Four boxes per step with SSE2 or NEON,
+// the PiZero has neither and takes the scalar loop
+unsigned int OverlapBoxes(Vec3D& min, Vec3D& max, BoxArray& boxes, int start) {
+    int end = std::min(start + COLLISION_BATCH, boxes.GetCount());
+    const float* minX = boxes.minX.data(); const float* minY = boxes.minY.data(); const float* minZ = boxes.minZ.data();
+    const float* maxX = boxes.maxX.data(); const float* maxY = boxes.maxY.data(); const float* maxZ = boxes.maxZ.data();
+    unsigned int mask = 0;
+    int i = start;
+
+#if defined(COLLISION_SSE2)
+    __m128 lowX = _mm_set1_ps(min.x), lowY = _mm_set1_ps(min.y), lowZ = _mm_set1_ps(min.z);
+    __m128 highX = _mm_set1_ps(max.x), highY = _mm_set1_ps(max.y), highZ = _mm_set1_ps(max.z);
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minX + i), highX), _mm_cmpge_ps(_mm_loadu_ps(maxX + i), lowX));
+        __m128 y = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minY + i), highY), _mm_cmpge_ps(_mm_loadu_ps(maxY + i), lowY));
+        __m128 z = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minZ + i), highZ), _mm_cmpge_ps(_mm_loadu_ps(maxZ + i), lowZ));
+        mask |= (unsigned int)_mm_movemask_ps(_mm_and_ps(x, _mm_and_ps(y, z))) << (i - start);
+    }
+#elif defined(COLLISION_NEON)
+    float32x4_t lowX = vdupq_n_f32(min.x), lowY = vdupq_n_f32(min.y), lowZ = vdupq_n_f32(min.z);
+    float32x4_t highX = vdupq_n_f32(max.x), highY = vdupq_n_f32(max.y), highZ = vdupq_n_f32(max.z);
+    static const uint32_t lanes[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vld1q_u32(lanes);
+
+    for (; i + 4 <= end; i += 4) {
+        uint32x4_t x = vandq_u32(vcleq_f32(vld1q_f32(minX + i), highX), vcgeq_f32(vld1q_f32(maxX + i), lowX));
+        uint32x4_t y = vandq_u32(vcleq_f32(vld1q_f32(minY + i), highY), vcgeq_f32(vld1q_f32(maxY + i), lowY));
+        uint32x4_t z = vandq_u32(vcleq_f32(vld1q_f32(minZ + i), highZ), vcgeq_f32(vld1q_f32(maxZ + i), lowZ));
+        uint32x4_t hits = vandq_u32(vandq_u32(x, vandq_u32(y, z)), bits);
+        uint32x2_t sum = vadd_u32(vget_low_u32(hits), vget_high_u32(hits));
+        mask |= vget_lane_u32(vpadd_u32(sum, sum), 0) << (i - start);
+    }
+#endif
+
+    for (; i < end; i++) {
+        unsigned int hit = (minX[i] <= max.x) & (maxX[i] >= min.x) & (minY[i] <= max.y) & (maxY[i] >= min.y) & (minZ[i] <= max.z) & (maxZ[i] >= min.z);
+        mask |= hit << (i - start);
+    }
+
+    return mask;
+}
+
+// MARK: - Broad phase
+
+BroadPhase::BroadPhase() {
+    for (int i = 0; i < COLLISION_TAGS; i++) {
+        _masks[i] = 0;
+    }
+}
+
+// MARK: - Objects
+
+// New objects are sorted into place by the next Find()
+void BroadPhase::Add(GameObject* object) {
+    CollisionEntry entry;
+    entry.object = object;
+    entry.projectile = -1;
+    entry.tag = object->GetTag();
+    object->GetBounds(entry.min, entry.max);
+
+    _objects.push_back(entry);
+}
+
+void BroadPhase::Remove(GameObject* object) {
+    _objects.erase(std::remove_if(_objects.begin(), _objects.end(), [object](const CollisionEntry &entry) {
+        return entry.object == object;
+    }), _objects.end());
+}
+
+// Objects with this tag collide with the objects and projectiles which have their tag bit in mask
+void BroadPhase::SetMask(int tag, unsigned int mask) {
+    if (tag < 0 || tag >= COLLISION_TAGS) {
+        RBLOG_NUM1("BroadPhase: Tag out of range", tag);
+        return;
+    }
+
+    _masks[tag] = mask;
+    _tags = 0;
+
+    for (int i = 0; i < COLLISION_TAGS; i++) {
+        if (_masks[i] != 0) {
+            _tags |= _masks[i] | COLLISION_BIT(i);
+        }
+    }
+}
+
+bool BroadPhase::IsPaired(int tag1, int tag2) {
+    return (GetMask(tag1) & COLLISION_BIT(tag2)) || (GetMask(tag2) & COLLISION_BIT(tag1));
+}
+
+// Dead objects never collide again, pooled ones are reused for new objects
+void BroadPhase::RemoveDead() {
+    _objects.erase(std::remove_if(_objects.begin(), _objects.end(), [](const CollisionEntry &entry) {
+        return entry.object->IsDead();
+    }), _objects.end());
+}
+
+// Bounds of this frame in place, read from the entity store. Entries of objects which died or left
+// the engine since the last frame are dropped, the order of the others changes only a little
+void BroadPhase::Refresh(EntityStore& entities, Vec3D& scroll) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < _objects.size(); i++) {
+        CollisionEntry& entry = _objects[i];
+        int n = entry.object->_entity;
+
+        if (!entities.IsLive(n) || (entities.flags[n] & ENTITY_DEAD)) {
+            continue;
+        }
+
+        if (entities.flags[n] & ENTITY_BOUNDS_CHANGED) {
+            entry.object->UpdateBounds();
+        }
+
+        Vec3D pos = entities.position[n];
+        if (entities.flags[n] & ENTITY_STATIC) {
+            pos = Vec3DAdd(pos, scroll);
+        }
+
+        entry.tag = entities.tag[n];
+        entry.min = Vec3DAdd(pos, entities.boundsMin[n]);
+        entry.max = Vec3DAdd(pos, entities.boundsMax[n]);
+
+        _objects[count++] = entry;
+    }
+
+    _objects.resize(count);
+    SortByMinZ(_objects);
+}
+
+// The box swept by each projectile in the last update, moved from level into world space
+void BroadPhase::AddProjectiles(ProjectileSystem& projectiles, Vec3D& scroll) {
+    float half = PROJECTILE_SIZE * 0.5f;
+    _projectiles.clear();
+
+    for (int i = 0; i < projectiles.GetCount(); i++) {
+        Projectile& p = projectiles.Get(i);
+
+        if (!projectiles.IsAlive(i) || !(_tags & COLLISION_BIT(p.tag))) {
+            continue;
+        }
+
+        Vec3D p1 = Vec3DAdd(p.last, scroll);
+        Vec3D p2 = Vec3DAdd(p.pos, scroll);
+
+        CollisionEntry entry;
+        entry.object = nullptr;
+        entry.projectile = i;
+        entry.tag = p.tag;
+        entry.min = Vec3DMakef(std::min(p1.x, p2.x) - half, std::min(p1.y, p2.y) - half, std::min(p1.z, p2.z) - half);
+        entry.max = Vec3DMakef(std::max(p1.x, p2.x) + half, std::max(p1.y, p2.y) + half, std::max(p1.z, p2.z) + half);
+
+        _projectiles.push_back(entry);
+    }
+
+    SortByMinZ(_projectiles);
+}
+
+// MARK: - Sweep
+
+// Both sorted lists are swept at once, only entries overlapping in z are paired
+void BroadPhase::Find(EntityStore& entities, ProjectileSystem& projectiles, Vec3D& scroll, std::vector<Collision>& collisions) {
+    collisions.clear();
+    _stats.frames++;
+
+    Refresh(entities, scroll);
+    AddProjectiles(projectiles, scroll);
+
+    _active.clear();
+    _activeBounds.Clear();
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i < _objects.size() || j < _projectiles.size()) {
+        CollisionEntry* entry;
+
+        if (j >= _projectiles.size() || (i < _objects.size() && _objects[i].min.z <= _projectiles[j].min.z)) {
+            entry = &_objects[i++];
+        }
+        else {
+            entry = &_projectiles[j++];
+        }
+
+        if (entry->tag < 0 || entry->tag >= COLLISION_TAGS || !(_tags & COLLISION_BIT(entry->tag))) {
+            continue;
+        }
+
+        // Entries ending before this one starts are done
+        for (size_t k = 0; k < _active.size(); ) {
+            if (_active[k]->max.z < entry->min.z) {
+                _active[k] = _active.back();
+                _active.pop_back();
+                _activeBounds.Remove((int)k);
+                continue;
+            }
+
+            k++;
+        }
+
+        // The remaining ones overlap in z, the batches also test x and y
+        for (int start = 0; start < _activeBounds.GetCount(); start += COLLISION_BATCH) {
+            unsigned int mask = OverlapBoxes(entry->min, entry->max, _activeBounds, start);
+
+            for (int n = 0; mask != 0; n++, mask >>= 1) {
+                if (mask & 1) {
+                    Test(*_active[start + n], *entry, projectiles, scroll, collisions);
+                }
+            }
+        }
+
+        _active.push_back(entry);
+        _activeBounds.Add(entry->min, entry->max);
+    }
+}
+
+void BroadPhase::Test(CollisionEntry& a, CollisionEntry& b, ProjectileSystem& projectiles, Vec3D& scroll, std::vector<Collision>& collisions) {
+    // Projectiles don't hit each other
+    if ((a.object == nullptr && b.object == nullptr) || !IsPaired(a.tag, b.tag)) {
+        return;
+    }
+
+    _stats.candidates++;
+
+    Collision collision;
+
+    if (a.object == nullptr || b.object == nullptr) {
+        CollisionEntry& entry = a.object != nullptr ? a : b;
+        Projectile& p = projectiles.Get(a.object != nullptr ? b.projectile : a.projectile);
+
+        // Moving the hit box along the segment equals moving its center through the grown bounds
+        float half = PROJECTILE_SIZE * 0.5f;
+        Vec3D p1 = Vec3DAdd(p.last, scroll);
+        Vec3D p2 = Vec3DAdd(p.pos, scroll);
+        Vec3D grownMin = Vec3DMakef(entry.min.x - half, entry.min.y - half, entry.min.z - half);
+        Vec3D grownMax = Vec3DMakef(entry.max.x + half, entry.max.y + half, entry.max.z + half);
+
+        if (!SegmentIntersectsBox(p1, p2, grownMin, grownMax)) {
+            return;
+        }
+
+        collision.object = entry.object;
+        collision.other = nullptr;
+        collision.projectile = a.object != nullptr ? b.projectile : a.projectile;
+    }
+    else {
+        // Chunk bounds enclose empty space, their boxes are tested one by one
+        if ((a.object->GetChunk() != nullptr || b.object->GetChunk() != nullptr) && !a.object->IsColliding(*b.object)) {
+            return;
+        }
+
+        bool first = (GetMask(a.tag) & COLLISION_BIT(b.tag)) != 0;
+        collision.object = first ? a.object : b.object;
+        collision.other = first ? b.object : a.object;
+        collision.projectile = -1;
+    }
+
+    collisions.push_back(collision);
+    _stats.collisions++;
+}
@@ -0,0 +1,94 @@
+//
+//  rb_collision.hpp
+//  3d wireframe game engine: collision detection
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_math.hpp"
+#include "rb_projectiles.hpp"
+
+#include <vector>
+
+// Tags taking part in collision detection must be below this, each is one bit of a mask
+#define COLLISION_TAGS      32
+#define COLLISION_BIT(tag)  (1u << (tag))
+
+// Boxes tested by one OverlapBoxes() call, one bit each in the result
+#define COLLISION_BATCH     32
+
+class EntityStore;
+class GameObject;
+
+// Confirmed collision, see BroadPhase::Find()
+struct Collision {
+    GameObject* object;         // Object whose mask contains the tag of the other one, the object hit by a projectile
+    GameObject* other;          // nullptr if a projectile hit the object
+    int projectile;             // Index of the projectile or -1
+};
+
+// Pairs found per frame, see GameEngine::FindCollisions()
+struct CollisionStats {
+    long frames = 0;
+    long candidates = 0;        // Pairs with overlapping bounds and matching tags
+    long collisions = 0;
+};
+
+// Axis aligned boxes, one array per component, see OverlapBoxes()
+struct BoxArray {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    void Clear();
+    void Add(Vec3D& min, Vec3D& max);
+    void Remove(int n);
+    int GetCount() { return (int)minX.size(); }
+};
+
+unsigned int OverlapBoxes(Vec3D& min, Vec3D& max, BoxArray& boxes, int start);
+
+// Object or projectile in the sweep list, bounds in world space
+struct CollisionEntry {
+    Vec3D min;
+    Vec3D max;
+    GameObject* object;
+    int projectile;
+    int tag;
+};
+
+// Sweep and prune along z, everything in the game moves along z. The object list stays
+// sorted from frame to frame, so an insertion sort over the nearly sorted list is enough
+class BroadPhase {
+public:
+    BroadPhase();
+
+    void Add(GameObject* object);
+    void Remove(GameObject* object);
+    void RemoveDead();
+    void Clear() { _objects.clear(); }
+
+    void SetMask(int tag, unsigned int mask);
+    unsigned int GetMask(int tag) { return tag >= 0 && tag < COLLISION_TAGS ? _masks[tag] : 0; }
+
+    void Find(EntityStore& entities, ProjectileSystem& projectiles, Vec3D& scroll, std::vector<Collision>& collisions);
+
+    CollisionStats& GetStats() { return _stats; }
+
+private:
+    void Refresh(EntityStore& entities, Vec3D& scroll);
+    void AddProjectiles(ProjectileSystem& projectiles, Vec3D& scroll);
+    void Test(CollisionEntry& a, CollisionEntry& b, ProjectileSystem& projectiles, Vec3D& scroll, std::vector<Collision>& collisions);
+    bool IsPaired(int tag1, int tag2);
+
+private:
+    std::vector<CollisionEntry> _objects;       // Sorted by min.z
+    std::vector<CollisionEntry> _projectiles;   // Built every frame, also sorted by min.z
+    std::vector<CollisionEntry*> _active;       // Entries the sweep position is still inside of in z
+    BoxArray _activeBounds;                     // Their bounds, tested in batches
+    unsigned int _masks[COLLISION_TAGS];
+    unsigned int _tags = 0;                     // All tags in any mask or with a mask
+    CollisionStats _stats;
+};
@@ -7,14 +7,15 @@
 //
 
 #include "rb_engine.hpp"
+#include "rb_pipeline.hpp"
 #include "rb_object.hpp"
 #include "rb_platform.h"
 #include "rb_log.h"
 #include "rb_vtext.h"
 #include "rb_math.hpp"
 
-#include <list>
 #include <algorithm>
+#include <string.h>
 
 #ifdef _WIN32
 extern "C" int win_sleep_ms(int wait);
@@ -23,39 +24,64 @@ extern "C" int win_sleep_ms(int wait);
 GameEngine::GameEngine() {
     _screenWidth = 640;
     _screenHeight = 480;
+    _renderWidth = _screenWidth;
+    _renderHeight = _screenHeight;
+
+    GameObject::SetEntities(&_entities);
 }
 
-GameEngine::~GameEngine() {}
+GameEngine::~GameEngine() {
+    GameObject::SetEntities(nullptr);
+}
 
 // MARK: - Text
 
 void GameEngine::DrawVectorString(char* msg, int x, int y, int size, byte color) {
-   vtext_draw_string(x, y, msg, 1, color);
+   vtext_draw_string(ToRenderX(x), ToRenderY(y), msg, GetRenderScale(), color);
 }
 
 void GameEngine::DrawString(char* msg, int x, int y, int size, byte color) {
-    vtext_draw_string(x, y, msg, 1, color);
+    vtext_draw_string(ToRenderX(x), ToRenderY(y), msg, GetRenderScale(), color);
 }
 
 // MARK: - Drawing
 
+// Screen coordinates are scaled to the current render size, see GetRenderScale()
 void GameEngine::DrawLine(int x1, int y1, int x2, int y2, byte color) {
-    platform_draw_line(x1, y1, x2, y2, color, INVERT_OFF);
+    platform_draw_line(ToRenderX(x1), ToRenderY(y1), ToRenderX(x2), ToRenderY(y2), color, INVERT_OFF);
 }
 
 void GameEngine::SetPixel(int x, int y, uint8_t paletteColor, int brightness) {
-    platform_set_pixel(x, y, paletteColor, brightness);
+    platform_set_pixel(ToRenderX(x), ToRenderY(y), paletteColor, brightness);
 }
 
+// Projected triangles are already in render coordinates, edges in the guard band get scissored here
 void GameEngine::DrawTriangle(Vec3D& vec1, Vec3D& vec2, Vec3D& vec3, byte color, int number) {
-    DrawLine(vec1.x, vec1.y, vec2.x, vec2.y, color);
-    DrawLine(vec2.x, vec2.y, vec3.x, vec3.y, color);
-    DrawLine(vec3.x, vec3.y, vec1.x, vec1.y, color);
+    DrawEdge(vec1, vec2, color);
+    DrawEdge(vec2, vec3, color);
+    DrawEdge(vec3, vec1, color);
+}
+
+void GameEngine::DrawEdge(Vec3D& v1, Vec3D& v2, byte color) {
+    float x1 = v1.x, y1 = v1.y, x2 = v2.x, y2 = v2.y;
+    if (LineClipAgainstRect(x1, y1, x2, y2, 0.0f, 0.0f, (float)GetClipMaxX(), (float)GetClipMaxY())) {
+        // Lines of a stereo view are drawn after all objects, see DrawStereoViews()
+        if (_view != nullptr) _view->lines.push_back({ x1, y1, x2, y2, color });
+        else platform_draw_line(x1, y1, x2, y2, color, INVERT_OFF);
+    }
 }
 
 void GameEngine::FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, uint8_t paletteColor, int brightness) {
     auto SWAP = [](int &x, int &y) { int t = x; x = y; y = t; };
-    auto drawline = [&](int sx, int ex, int ny) { for (int i = sx; i <= ex; i++) SetPixel(i, ny, paletteColor, brightness); };
+    int maxX = GetClipMaxX();
+    int maxY = GetClipMaxY();
+    auto drawline = [&](int sx, int ex, int ny) {
+        // Scissor, triangles in the guard band are not clipped before
+        if (ny < 0 || ny > maxY) return;
+        if (sx < 0) sx = 0;
+        if (ex > maxX) ex = maxX;
+        for (int i = sx; i <= ex; i++) platform_set_pixel(i, ny, paletteColor, brightness);
+    };
 
     int t1x, t2x, y, minx, maxx, t1xp, t2xp;
     bool changed1 = false;
@@ -230,189 +256,1184 @@ next:
 void GameEngine::Clip(int& x, int& y) {
     if (x < 0) x = 0;
     
-    if (x >= _screenWidth)
-        x = _screenWidth;
+    if (x >= _renderWidth)
+        x = _renderWidth;
     
     if (y < 0) y = 0;
     
-    if (y >= _screenHeight)
-        y = _screenHeight;
+    if (y >= _renderHeight)
+        y = _renderHeight;
 }
 
-void GameEngine::ClipAndDraw(std::vector<Triangle>& vecTrianglesToRaster, byte color) {
-    // Loop through all transformed, viewed, projected, and sorted triangles
-    for (auto &triToRaster : vecTrianglesToRaster) {
-        // Clip triangles against all four screen edges, this could yield
-        // a bunch of triangles, so create a queue that we traverse to
-        // ensure we only test new triangles generated against planes
-        Triangle clipped[2];
-        std::list<Triangle> listTriangles;
+// Draw the projected triangles of an object, returns the number of triangles drawn
+template <class Fill, class Clip, class Output>
+int GameEngine::RasterWith(std::vector<Triangle>& vecTrianglesToRaster) {
+    return Clip::template Raster<Fill, Output>(*this, vecTrianglesToRaster);
+}
 
-        // Add initial triangle
-        listTriangles.push_back(triToRaster);
-        int nNewTriangles = 1;
+// Bounding sphere of the mesh in view space, returns the radius
+float GameEngine::GetViewSphere(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, Vec3D& center) {
+    if (mesh.radius < 0.0f) {
+        mesh.UpdateBounds();
+    }
 
-        for (int p = 0; p < 4; p++) {
-            int nTrisToAdd = 0;
-            
-            while (nNewTriangles > 0) {
-                // Take triangle from front of queue
-                Triangle test = listTriangles.front();
-                listTriangles.pop_front();
-                nNewTriangles--;
-
-                // Clip it against a plane. We only need to test each
-                // subsequent plane, against subsequent new triangles
-                // as all triangles after a plane clip are guaranteed
-                // to lie on the inside of the plane. I like how this
-                // comment is almost completely and utterly justified
-                switch (p) {
-                    case 0: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakeZero(), Vec3DMakef(0.0f, 1.0f, 0.0f), test, clipped[0], clipped[1]); break;
-                    case 1: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakef(0.0f, (float)_screenWidth - 1, 0.0f), Vec3DMakef(0.0f, -1.0f, 0.0f) , test, clipped[0], clipped[1]); break;
-                    case 2: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakeZero(), Vec3DMakef(1.0f, 0.0f, 0.0f), test, clipped[0], clipped[1]); break;
-                    case 3: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakef((float)_screenWidth - 1, 0.0f, 0.0f), Vec3DMakef(-1.0f, 0.0f, 0.0f), test, clipped[0], clipped[1]); break;
+    // Same transformation as Transform(), scale and rotation are applied around the origin
+    Mat4x4 matScale = MatrixMakeScale(scale.x, scale.y, scale.z);
+    Mat4x4 matRotX = MatrixMakeRotationX(rot.x);
+    Mat4x4 matRotY = MatrixMakeRotationY(rot.y);
+    Mat4x4 matRotZ = MatrixMakeRotationZ(rot.z);
+
+    center = MatrixMultiplyVector(matScale, mesh.center);
+    center = MatrixMultiplyVector(matRotX, center);
+    center = MatrixMultiplyVector(matRotY, center);
+    center = MatrixMultiplyVector(matRotZ, center);
+    center = MatrixMultiplyVector(_matWorld, center);
+    center = Vec3DAdd(center, pos);
+    center = MatrixMultiplyVector(GetViewMatrix(), center);
+
+    // Rotation, world and view matrices are rigid, only the scale changes the radius
+    return mesh.radius * std::max(fabsf(scale.x), std::max(fabsf(scale.y), fabsf(scale.z)));
+}
+
+// Classify the bounding sphere of the mesh against the view frustum (near plane and guard band edges)
+int GameEngine::ClassifyMesh(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale) {
+    Vec3D center;
+    float radius = GetViewSphere(mesh, pos, rot, scale, center);
+
+    return ClassifySphere(center, radius);
+}
+
+// Bounding sphere in view space against the view frustum
+int GameEngine::ClassifySphere(Vec3D& center, float radius) {
+    // Near plane
+    if (center.z + radius < 0.1f) return FRUSTUM_OUTSIDE;
+    int result = center.z - radius < 0.1f ? FRUSTUM_INTERSECT : FRUSTUM_INSIDE;
+
+    // Side planes through the eye, from the normalised device range that maps onto
+    // the guard band (x/y are flipped and offset into screen space by Transform)
+    float w = (float)_renderWidth;
+    float h = (float)_renderHeight;
+    float px = _matProj.m[0][0];
+    float py = _matProj.m[1][1];
+    float limits[4][3] = {
+        { px, 0.0f, 1.0f + 2.0f * CLIP_GUARD_BAND / w },                               // ndc x <= limit
+        { -px, 0.0f, -(1.0f - 2.0f * (GetClipMaxX() + CLIP_GUARD_BAND) / w) },          // ndc x >= limit
+        { 0.0f, py, 1.0f + 2.0f * CLIP_GUARD_BAND / h },                               // ndc y <= limit
+        { 0.0f, -py, -(1.0f - 2.0f * (GetClipMaxY() + CLIP_GUARD_BAND) / h) }           // ndc y >= limit
+    };
+
+    for (int i = 0; i < 4; i++) {
+        float a = limits[i][0], b = limits[i][1], c = limits[i][2];
+        float dist = (a * center.x + b * center.y - c * center.z) / sqrtf(a * a + b * b + c * c);
+
+        if (dist > radius) return FRUSTUM_OUTSIDE;
+        if (dist > -radius) result = FRUSTUM_INTERSECT;
+    }
+
+    return result;
+}
+
+// The vertex storage is chosen once per mesh, the kernel is instantiated for both
+template <class Lighting, class Sort, class Clip>
+void GameEngine::TransformWith(std::vector<Triangle>& vecTrianglesToRaster, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale) {
+    if (mesh.normals.size() != mesh.GetTriangleCount()) {
+        mesh.UpdateNormals();
+    }
+
+    if (mesh.quantised) TransformMesh<Lighting, Clip, VerticesQuantised>(vecTrianglesToRaster, mesh, pos, rot, scale);
+    else TransformMesh<Lighting, Clip, VerticesFloat>(vecTrianglesToRaster, mesh, pos, rot, scale);
+
+    // Sort triangles from back to front
+    Sort::Apply(vecTrianglesToRaster);
+}
+
+template <class Lighting, class Clip, class Vertices>
+void GameEngine::TransformMesh(std::vector<Triangle>& vecTrianglesToRaster, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale) {
+    // Camera and light in scaled object space, normals of scaled faces are
+    // scaled by the cofactors, that way no normal has to be transformed
+    Mat4x4 matInverse;
+    Mat4x4 matModelView = BuildModelView(pos, rot, scale, matInverse);
+    Vec3D eye = MatrixMultiplyVector(matInverse, GetViewCamera());
+    Vec3D light = Vec3DMakef(0.0f, LIGHT_DIRECTION_Y, LIGHT_DIRECTION_Z);
+    if (Lighting::enabled) {
+        light.w = 0.0f;
+        light = MatrixMultiplyVector(matInverse, light);
+    }
+
+    Vec3D cofactors = Vec3DMakef(scale.y * scale.z, scale.x * scale.z, scale.x * scale.y);
+    bool uniform = scale.x == scale.y && scale.y == scale.z && scale.x > 0.0f;
+    bool unrotated = matInverse.m[0][0] == 1.0f && matInverse.m[1][1] == 1.0f && matInverse.m[2][2] == 1.0f;
+
+    size_t count = mesh.GetTriangleCount();
+
+    for (size_t i = 0; i < count; i++) {
+        Triangle triViewed;
+
+        // Backface culling before any vertex gets transformed
+        Vec3D p0 = Vertices::Get(mesh, i, 0);
+        Vec3D normal = Vec3DMakef(mesh.normals[i].x * cofactors.x, mesh.normals[i].y * cofactors.y, mesh.normals[i].z * cofactors.z);
+        Vec3D cameraRay = Vec3DMakef(p0.x * scale.x - eye.x, p0.y * scale.y - eye.y, p0.z * scale.z - eye.z);
+
+        // If ray is aligned with normal, then triangle is visible
+        if (Vec3DDotProduct(normal, cameraRay) < 0.0f) {
+            triViewed.bright = BRIGHTNESS_OFF;
+
+            if (Lighting::enabled) {
+                float dp;
+                if (uniform && unrotated) {
+                    dp = mesh.light[i];
+                }
+                else {
+                    float length = uniform ? cofactors.x : Vec3DLength(normal);
+                    dp = std::max(0.1f, Vec3DDotProduct(light, normal) / length);
                 }
 
-                // Clipping may yield a variable number of triangles, so
-                // add these new ones to the back of the queue for subsequent
-                // clipping against next planes
-                for (int w = 0; w < nTrisToAdd; w++) {
-                    listTriangles.push_back(clipped[w]);
+                triViewed.bright = GetBrightness(dp);
+            }
+
+            triViewed.color = Vertices::Color(mesh, i);
+
+            // Convert Object Space --> View Space
+            Vec3D p1 = Vertices::Get(mesh, i, 1);
+            Vec3D p2 = Vertices::Get(mesh, i, 2);
+            triViewed.p[0] = MatrixMultiplyVector(matModelView, p0);
+            triViewed.p[1] = MatrixMultiplyVector(matModelView, p1);
+            triViewed.p[2] = MatrixMultiplyVector(matModelView, p2);
+
+            ProjectTriangle<Clip>(triViewed, Vertices::Hide(mesh, i), vecTrianglesToRaster);
+        }
+    }
+
+}
+
+// Near plane clipping and projection of a triangle in view space
+template <class Clip>
+void GameEngine::ProjectTriangle(Triangle& triViewed, int hide, std::vector<Triangle>& vecTrianglesToRaster) {
+    Triangle triProjected;
+
+    // Clip Viewed Triangle against near plane, not needed for objects fully in front of it
+    int nClippedTriangles = 1;
+    Triangle clipped[2];
+    if (Clip::nearPlane) {
+        nClippedTriangles = TriangleClipAgainstPlane(Vec3DMakef(0.0f, 0.0f, 0.1f), Vec3DMakef(0.0f, 0.0f, 1.0f), triViewed, clipped[0], clipped[1]);
+    }
+    else {
+        clipped[0] = triViewed;
+    }
+
+    // We may end up with multiple triangles form the clip, so project as required
+    for (int n = 0; n < nClippedTriangles; n++) {
+        // Project triangles from 3D --> 2D
+        triProjected.p[0] = MatrixMultiplyVector(_matProj, clipped[n].p[0]);
+        triProjected.p[1] = MatrixMultiplyVector(_matProj, clipped[n].p[1]);
+        triProjected.p[2] = MatrixMultiplyVector(_matProj, clipped[n].p[2]);
+        triProjected.bright = clipped[n].bright;
+        triProjected.color = clipped[n].color;
+
+        // Scale into view, we moved the normalising into cartesian space
+        // out of the matrix.vector function from the previous videos, so do this manually
+        triProjected.p[0] = Vec3DDiv(triProjected.p[0], triProjected.p[0].w);
+        triProjected.p[1] = Vec3DDiv(triProjected.p[1], triProjected.p[1].w);
+        triProjected.p[2] = Vec3DDiv(triProjected.p[2], triProjected.p[2].w);
+
+        // X/Y are inverted so put them back
+        triProjected.p[0].x *= -1.0f;
+        triProjected.p[1].x *= -1.0f;
+        triProjected.p[2].x *= -1.0f;
+        triProjected.p[0].y *= -1.0f;
+        triProjected.p[1].y *= -1.0f;
+        triProjected.p[2].y *= -1.0f;
+
+        // Offset verts into visible normalised space
+        Vec3D vOffsetView = Vec3DMakef(1.0f, 1.0f, 0.0f);
+        triProjected.p[0] = Vec3DAdd(triProjected.p[0], vOffsetView);
+        triProjected.p[1] = Vec3DAdd(triProjected.p[1], vOffsetView);
+        triProjected.p[2] = Vec3DAdd(triProjected.p[2], vOffsetView);
+        triProjected.p[0].x *= 0.5f * (float)_renderWidth;
+        triProjected.p[0].y *= 0.5f * (float)_renderHeight;
+        triProjected.p[1].x *= 0.5f * (float)_renderWidth;
+        triProjected.p[1].y *= 0.5f * (float)_renderHeight;
+        triProjected.p[2].x *= 0.5f * (float)_renderWidth;
+        triProjected.p[2].y *= 0.5f * (float)_renderHeight;
+
+        // Save drawing flag
+        triProjected.h = hide;
+
+        // Store triangle for sorting
+        vecTrianglesToRaster.push_back(triProjected);
+    }
+}
+
+// Object space --> world space, matInverse is the inverse of the rigid part (rotation,
+// world matrix and position) that moves the camera and light into object space
+Mat4x4 GameEngine::BuildModel(Vec3D& pos, Vec3D& rot, Vec3D& scale, Mat4x4& matInverse) {
+    Mat4x4 matRotX = MatrixMakeRotationX(rot.x);
+    Mat4x4 matRotY = MatrixMakeRotationY(rot.y);
+    Mat4x4 matRotZ = MatrixMakeRotationZ(rot.z);
+    Mat4x4 matRigid = MatrixMultiplyMatrix(matRotX, matRotY);
+    matRigid = MatrixMultiplyMatrix(matRigid, matRotZ);
+    matRigid = MatrixMultiplyMatrix(matRigid, _matWorld);
+    matRigid.m[3][0] += pos.x;
+    matRigid.m[3][1] += pos.y;
+    matRigid.m[3][2] += pos.z;
+
+    matInverse = MatrixQuickInverse(matRigid);
+
+    Mat4x4 matScale = MatrixMakeScale(scale.x, scale.y, scale.z);
+
+    return MatrixMultiplyMatrix(matScale, matRigid);
+}
+
+// Object space --> view space in one step
+Mat4x4 GameEngine::BuildModelView(Vec3D& pos, Vec3D& rot, Vec3D& scale, Mat4x4& matInverse) {
+    Mat4x4 matModel = BuildModel(pos, rot, scale, matInverse);
+
+    return MatrixMultiplyMatrix(matModel, GetViewMatrix());
+}
+
+// Edge mode: silhouette edges (between a front and a back face), open borders and creases
+// of front faces, as pairs of screen points
+void GameEngine::TransformEdges(std::vector<Vec3D>& lines, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, bool clip) {
+    if (mesh.normals.size() != mesh.GetTriangleCount()) {
+        mesh.UpdateNormals();
+    }
+
+    Mat4x4 matInverse;
+    Mat4x4 matModelView = BuildModelView(pos, rot, scale, matInverse);
+    Vec3D eye = MatrixMultiplyVector(matInverse, GetViewCamera());
+    Vec3D cofactors = Vec3DMakef(scale.y * scale.z, scale.x * scale.z, scale.x * scale.y);
+
+    // Facing of all faces first, every edge needs both of its faces
+    size_t count = mesh.GetTriangleCount();
+    int frontFaces = 0;
+    _frontFaces.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        Vec3D p0 = mesh.GetVertex(i, 0);
+        Vec3D normal = Vec3DMakef(mesh.normals[i].x * cofactors.x, mesh.normals[i].y * cofactors.y, mesh.normals[i].z * cofactors.z);
+        Vec3D cameraRay = Vec3DMakef(p0.x * scale.x - eye.x, p0.y * scale.y - eye.y, p0.z * scale.z - eye.z);
+
+        _frontFaces[i] = Vec3DDotProduct(normal, cameraRay) < 0.0f;
+        frontFaces += _frontFaces[i];
+    }
+
+    // Vertices are shared by several edges, each one is transformed once
+    _edgeVertices.resize(mesh.vertexCount);
+    for (auto &vertex : _edgeVertices) {
+        vertex.done = false;
+    }
+
+    auto transform = [&](MeshEdge& edge, int i) -> EdgeVertex& {
+        EdgeVertex& vertex = _edgeVertices[edge.vertex[i]];
+
+        if (!vertex.done) {
+            Vec3D p = mesh.GetVertex(edge.face[0], (edge.corner + i) % 3);
+            vertex.viewed = MatrixMultiplyVector(matModelView, p);
+            vertex.screen = ProjectViewed(vertex.viewed);
+            vertex.done = true;
+        }
+
+        return vertex;
+    };
+
+    int edgesDrawn = 0;
+
+    for (auto &edge : mesh.edges) {
+        bool front0 = _frontFaces[edge.face[0]];
+        bool front1 = edge.face[1] >= 0 && _frontFaces[edge.face[1]];
+        bool draw = edge.face[1] < 0 ? front0 : front0 != front1 || (front0 && edge.crease);
+
+        if (!draw) {
+            continue;
+        }
+
+        EdgeVertex& v1 = transform(edge, 0);
+        EdgeVertex& v2 = transform(edge, 1);
+
+        // Clip against near plane, not needed for objects fully in front of it
+        if (clip && (v1.viewed.z < 0.1f || v2.viewed.z < 0.1f)) {
+            if (v1.viewed.z < 0.1f && v2.viewed.z < 0.1f) {
+                continue;
+            }
+
+            Vec3D plane = Vec3DMakef(0.0f, 0.0f, 0.1f);
+            Vec3D normal = Vec3DMakef(0.0f, 0.0f, 1.0f);
+            Vec3D viewed1 = v1.viewed;
+            Vec3D viewed2 = v2.viewed;
+
+            if (viewed1.z < 0.1f) viewed1 = Vec3DIntersectPlane(plane, normal, viewed2, viewed1);
+            else viewed2 = Vec3DIntersectPlane(plane, normal, viewed1, viewed2);
+
+            lines.push_back(ProjectViewed(viewed1));
+            lines.push_back(ProjectViewed(viewed2));
+        }
+        else {
+            lines.push_back(v1.screen);
+            lines.push_back(v2.screen);
+        }
+
+        edgesDrawn++;
+    }
+
+    mesh.edgeStats.draws++;
+    mesh.edgeStats.edgesDrawn += edgesDrawn;
+    mesh.edgeStats.wireframeEdges += 3 * frontFaces;
+}
+
+void GameEngine::DrawLines(std::vector<Vec3D>& lines, byte color) {
+    for (size_t i = 0; i + 1 < lines.size(); i += 2) {
+        DrawEdge(lines[i], lines[i + 1], color);
+    }
+}
+
+// World-static objects are placed in level space and drawn with the scrolled view,
+// the projection is stored in cache if given
+void GameEngine::DrawMesh(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, byte color, bool isStatic, ProjectionCache* cache) {
+    _drawStatic = isStatic;
+
+    // Objects fully inside the frustum skip all clipping
+    int visibility = ClassifyMesh(mesh, pos, rot, scale);
+    if (cache != nullptr) {
+        cache->visibility = visibility;
+        cache->isBox = false;
+        cache->isLines = false;
+        cache->tris.clear();
+        cache->lines.clear();
+    }
+
+    if (visibility == FRUSTUM_OUTSIDE) {
+        _drawStatic = false;
+        return;
+    }
+
+    if (mesh.box && visibility == FRUSTUM_INSIDE) {
+        BoxProjection projection;
+        BoxProjection& box = cache != nullptr ? cache->box : projection;
+
+        mesh.color = color;
+        ProjectBox(pos, rot, scale, box);
+        DrawProjectedBox(box, color);
+
+        if (cache != nullptr) cache->isBox = true;
+        _drawStatic = false;
+        return;
+    }
+
+    // Meshes with adjacency (loaded models) are drawn with their outline in edge mode
+    if (_edgeMode && !_filled && !mesh.edges.empty()) {
+        std::vector<Vec3D> projected;
+        std::vector<Vec3D>& lines = cache != nullptr ? cache->lines : projected;
+
+        mesh.color = color;
+        TransformEdges(lines, mesh, pos, rot, scale, visibility == FRUSTUM_INTERSECT);
+        DrawLines(lines, color);
+
+        if (cache != nullptr) cache->isLines = true;
+        _drawStatic = false;
+        return;
+    }
+
+    std::vector<Triangle> triangles;
+    std::vector<Triangle>& vecTrianglesToRaster = cache != nullptr ? cache->tris : triangles;
+    const RenderVariant& variant = GetRenderVariant(visibility);
+    mesh.color = color;
+    (this->*variant.transform)(vecTrianglesToRaster, mesh, pos, rot, scale);
+    (this->*variant.raster)(vecTrianglesToRaster);
+
+    _drawStatic = false;
+}
+
+// Objects with unchanged model and view are drawn from the projection of the last frame
+void GameEngine::DrawGameObject(GameObject* gameObject) {
+    ProjectionCache& cache = gameObject->GetProjectionCache();
+    unsigned int staticViewVersion = gameObject->IsStatic() ? _staticViewVersion : 0;
+    byte color = gameObject->GetColor();
+
+    if (cache.valid && cache.modelVersion == gameObject->GetModelVersion() &&
+        cache.viewVersion == _viewVersion && cache.staticViewVersion == staticViewVersion) {
+        _cacheStats.hits++;
+        _cacheStats.trianglesReused += cache.tris.size();
+
+        if (cache.visibility == FRUSTUM_OUTSIDE) return;
+
+        if (cache.isBox) DrawProjectedBox(cache.box, color);
+        else if (cache.isLines) DrawLines(cache.lines, color);
+        else (this->*GetRenderVariant(cache.visibility).raster)(cache.tris);
+        return;
+    }
+
+    _cacheStats.misses++;
+
+    DrawMesh(*gameObject->GetMesh(), gameObject->GetPosition(), gameObject->GetRotation(), gameObject->GetScale(), color, gameObject->IsStatic(), &cache);
+
+    cache.valid = true;
+    cache.modelVersion = gameObject->GetModelVersion();
+    cache.viewVersion = _viewVersion;
+    cache.staticViewVersion = staticViewVersion;
+}
+
+// MARK: - Render pipelines
+
+typedef RenderPipeline<FillWireframe, LightingOff, SortOff, ClipNone, OutputScreen> WireframeInside;
+typedef RenderPipeline<FillWireframe, LightingOff, SortOff, ClipFrustum, OutputScreen> WireframeIntersect;
+typedef RenderPipeline<FillSolid, LightingOn, SortOn, ClipNone, OutputScreen> FilledInside;
+typedef RenderPipeline<FillSolid, LightingOn, SortOn, ClipFrustum, OutputScreen> FilledIntersect;
+
+// Pipelines of objects inside the frustum and objects crossing it
+static const RenderVariant s_wireframeVariants[2] = {
+    MakeRenderVariant<WireframeInside>("wireframe inside"),
+    MakeRenderVariant<WireframeIntersect>("wireframe intersect")
+};
+
+static const RenderVariant s_filledVariants[2] = {
+    MakeRenderVariant<FilledInside>("filled inside"),
+    MakeRenderVariant<FilledIntersect>("filled intersect")
+};
+
+// Wireframe lines need neither brightness nor back to front order
+void GameEngine::SelectRenderPipeline() {
+    _renderVariants = _filled ? s_filledVariants : s_wireframeVariants;
+}
+
+const RenderVariant& GameEngine::GetRenderVariant(int visibility) {
+    return _renderVariants[visibility == FRUSTUM_INSIDE ? 0 : 1];
+}
+
+// One benchmark row, the same policies with both clip strategies
+#define BENCHMARK_PIPELINE(fill, lighting, sort, output) { \
+    MakeRenderVariant<RenderPipeline<fill, lighting, sort, ClipNone, output> >(#fill " " #lighting " " #sort " " #output), \
+    MakeRenderVariant<RenderPipeline<fill, lighting, sort, ClipFrustum, output> >(#fill " " #lighting " " #sort " " #output) }
+
+// Draws the visible game objects with every pipeline variant and logs the time per frame,
+// objects are classified (inside objects skip clipping) or all clipped, nothing is updated or cached
+void GameEngine::BenchmarkPipelines(int frames) {
+    static const RenderVariant s_benchmark[][2] = {
+        BENCHMARK_PIPELINE(FillWireframe, LightingOff, SortOff, OutputScreen),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOff, SortOn, OutputScreen),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOn, SortOff, OutputScreen),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOn, SortOn, OutputScreen),
+        BENCHMARK_PIPELINE(FillSolid, LightingOff, SortOff, OutputScreen),
+        BENCHMARK_PIPELINE(FillSolid, LightingOff, SortOn, OutputScreen),
+        BENCHMARK_PIPELINE(FillSolid, LightingOn, SortOff, OutputScreen),
+        BENCHMARK_PIPELINE(FillSolid, LightingOn, SortOn, OutputScreen),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOff, SortOff, OutputNone),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOff, SortOn, OutputNone),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOn, SortOff, OutputNone),
+        BENCHMARK_PIPELINE(FillWireframe, LightingOn, SortOn, OutputNone),
+        BENCHMARK_PIPELINE(FillSolid, LightingOff, SortOff, OutputNone),
+        BENCHMARK_PIPELINE(FillSolid, LightingOff, SortOn, OutputNone),
+        BENCHMARK_PIPELINE(FillSolid, LightingOn, SortOff, OutputNone),
+        BENCHMARK_PIPELINE(FillSolid, LightingOn, SortOn, OutputNone)
+    };
+
+    const RenderVariant* frameVariants = _renderVariants;
+    std::vector<Triangle> triangles;
+
+    RBLOG_NUM1("GameEngine: Pipeline benchmark (# of frames)", frames);
+
+    for (auto &row : s_benchmark) {
+        for (int clipAll = 0; clipAll < 2; clipAll++) {
+            RenderVariant variants[2] = { clipAll ? row[1] : row[0], row[1] };
+            _renderVariants = variants;
+
+            long count = 0;
+            double start = platform_get_ms();
+
+            for (int frame = 0; frame < frames; frame++) {
+                for (int i = 0; i < _entities.GetLiveCount(); i++) {
+                    if (_entities.flags[i] & (ENTITY_DEAD | ENTITY_HIDDEN)) {
+                        continue;
+                    }
+
+                    GameObject* gameObject = _entities.owners[i];
+
+                    Mesh& mesh = *gameObject->GetMesh();
+                    _drawStatic = gameObject->IsStatic();
+
+                    int visibility = ClassifyMesh(mesh, gameObject->GetPosition(), gameObject->GetRotation(), gameObject->GetScale());
+                    if (visibility != FRUSTUM_OUTSIDE) {
+                        const RenderVariant& variant = GetRenderVariant(visibility);
+
+                        triangles.clear();
+                        mesh.color = gameObject->GetColor();
+                        (this->*variant.transform)(triangles, mesh, gameObject->GetPosition(), gameObject->GetRotation(), gameObject->GetScale());
+                        count += (this->*variant.raster)(triangles);
+                    }
+
+                    _drawStatic = false;
                 }
             }
-            
-            nNewTriangles = (int)listTriangles.size();
+
+            RBLOG_STR1(clipAll ? " Clip all  " : " Classified", row[0].name);
+            RBLOG_FLOAT1("  ms per frame", (float)(platform_get_ms() - start) / frames);
+            RBLOG_NUM1("  Triangles per frame", (int)(count / frames));
         }
-        
-        for (auto &t : listTriangles) {
-            if (_filled) FillTriangle(t.p[0].x, t.p[0].y, t.p[1].x, t.p[1].y, t.p[2].x, t.p[2].y, t.color, t.bright);
-            else DrawTriangle(t.p[0], t.p[1], t.p[2], color, t.h);
+    }
+
+    _renderVariants = frameVariants;
+}
+
+// MARK: - Boxes
+
+// Corners are indexed by their coordinates: x | y << 1 | z << 2
+// Faces in the order and winding of GameObject::PrimtiveGetCube(), drawn as (a, b, c) and (a, c, d)
+static const int s_boxFaces[6][4] = {
+    { 0, 2, 3, 1 },     // South
+    { 1, 3, 7, 5 },     // East
+    { 5, 7, 6, 4 },     // North
+    { 4, 6, 2, 0 },     // West
+    { 2, 6, 7, 3 },     // Top
+    { 5, 4, 0, 1 }      // Bottom
+};
+
+BoxInstance& GameEngine::GetBoxInstance(Vec3D& rot, Vec3D& scale) {
+    for (int i = 0; i < _boxInstanceCount; i++) {
+        BoxInstance& instance = _boxInstances[i];
+        if (instance.rot.x == rot.x && instance.rot.y == rot.y && instance.rot.z == rot.z &&
+            instance.scale.x == scale.x && instance.scale.y == scale.y && instance.scale.z == scale.z) {
+            return instance;
         }
     }
+
+    // Not cached, replace the oldest entry
+    BoxInstance& instance = _boxInstances[_boxInstanceNext];
+    _boxInstanceNext = (_boxInstanceNext + 1) % BOX_INSTANCE_CACHE;
+    if (_boxInstanceCount < BOX_INSTANCE_CACHE) _boxInstanceCount++;
+
+    instance.rot = rot;
+    instance.scale = scale;
+
+    Mat4x4 matScale = MatrixMakeScale(scale.x, scale.y, scale.z);
+    Mat4x4 matRotX = MatrixMakeRotationX(rot.x);
+    Mat4x4 matRotY = MatrixMakeRotationY(rot.y);
+    Mat4x4 matRotZ = MatrixMakeRotationZ(rot.z);
+
+    for (int i = 0; i < 8; i++) {
+        Vec3D corner = Vec3DMakef(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        corner = MatrixMultiplyVector(matScale, corner);
+        corner = MatrixMultiplyVector(matRotX, corner);
+        corner = MatrixMultiplyVector(matRotY, corner);
+        instance.corners[i] = MatrixMultiplyVector(matRotZ, corner);
+    }
+
+    for (int f = 0; f < 6; f++) {
+        Vec3D line1 = Vec3DSub(instance.corners[s_boxFaces[f][1]], instance.corners[s_boxFaces[f][0]]);
+        Vec3D line2 = Vec3DSub(instance.corners[s_boxFaces[f][2]], instance.corners[s_boxFaces[f][0]]);
+        Vec3D normal = Vec3DCrossProduct(line1, line2);
+        instance.normals[f] = Vec3DNormalise(normal);
+    }
+
+    return instance;
+}
+
+// Same projection as Transform(), from world space to render coordinates
+Vec3D GameEngine::ProjectToScreen(Vec3D& world) {
+    Vec3D viewed = MatrixMultiplyVector(GetViewMatrix(), world);
+
+    return ProjectViewed(viewed);
 }
 
-void GameEngine::Transform(std::vector<Triangle>& vecTrianglesToRaster, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale) {
-    for (auto tri : mesh.tris) {
-        Triangle triProjected, triTransformed, triRotated, triScaled, triViewed;
+Vec3D GameEngine::ProjectViewed(Vec3D& viewed) {
+    Vec3D projected = MatrixMultiplyVector(_matProj, viewed);
+    projected = Vec3DDiv(projected, projected.w);
 
-        Mat4x4 matScale = MatrixMakeScale(scale.x, scale.y, scale.z);
-        triScaled.p[0] = MatrixMultiplyVector(matScale, tri.p[0]);
-        triScaled.p[1] = MatrixMultiplyVector(matScale, tri.p[1]);
-        triScaled.p[2] = MatrixMultiplyVector(matScale, tri.p[2]);
+    projected.x = (1.0f - projected.x) * 0.5f * (float)_renderWidth;
+    projected.y = (1.0f - projected.y) * 0.5f * (float)_renderHeight;
 
-        Mat4x4 matRotX = MatrixMakeRotationX(rot.x);
-        Mat4x4 matRotY = MatrixMakeRotationY(rot.y);
-        Mat4x4 matRotZ = MatrixMakeRotationZ(rot.z);
+    return projected;
+}
 
-        triRotated.p[0] = MatrixMultiplyVector(matRotX, triScaled.p[0]);
-        triRotated.p[1] = MatrixMultiplyVector(matRotX, triScaled.p[1]);
-        triRotated.p[2] = MatrixMultiplyVector(matRotX, triScaled.p[2]);
+// Box fully inside the frustum: transform the 8 corners once, draw the visible faces or their edges
+void GameEngine::DrawBox(Vec3D& pos, Vec3D& rot, Vec3D& scale, byte color) {
+    BoxProjection box;
 
-        triRotated.p[0] = MatrixMultiplyVector(matRotY, triRotated.p[0]);
-        triRotated.p[1] = MatrixMultiplyVector(matRotY, triRotated.p[1]);
-        triRotated.p[2] = MatrixMultiplyVector(matRotY, triRotated.p[2]);
+    ProjectBox(pos, rot, scale, box);
+    DrawProjectedBox(box, color);
+}
 
-        triRotated.p[0] = MatrixMultiplyVector(matRotZ, triRotated.p[0]);
-        triRotated.p[1] = MatrixMultiplyVector(matRotZ, triRotated.p[1]);
-        triRotated.p[2] = MatrixMultiplyVector(matRotZ, triRotated.p[2]);
+// Visible faces, their brightness and the screen position of their corners
+void GameEngine::ProjectBox(Vec3D& pos, Vec3D& rot, Vec3D& scale, BoxProjection& box) {
+    BoxInstance& instance = GetBoxInstance(rot, scale);
+    Vec3D world[8];
 
-        // World Matrix Transform
-        triTransformed.p[0] = MatrixMultiplyVector(_matWorld, triRotated.p[0]);
-        triTransformed.p[1] = MatrixMultiplyVector(_matWorld, triRotated.p[1]);
-        triTransformed.p[2] = MatrixMultiplyVector(_matWorld, triRotated.p[2]);
+    for (int i = 0; i < 8; i++) {
+        world[i] = MatrixMultiplyVector(_matWorld, instance.corners[i]);
+        world[i] = Vec3DAdd(world[i], pos);
+    }
 
-        triTransformed.p[0] = Vec3DAdd(triTransformed.p[0], pos);
-        triTransformed.p[1] = Vec3DAdd(triTransformed.p[1], pos);
-        triTransformed.p[2] = Vec3DAdd(triTransformed.p[2], pos);
+    ProjectBoxCorners(instance, world, box);
+}
 
-        // Calculate triangle normal
-        Vec3D normal, line1, line2;
+// Corners in world space (level space for static objects)
+void GameEngine::ProjectBoxCorners(BoxInstance& instance, Vec3D* world, BoxProjection& box) {
+    Vec3D& camera = GetViewCamera();
+    int projected = 0;
 
-        line1 = Vec3DSub(triTransformed.p[1], triTransformed.p[0]);
-        line2 = Vec3DSub(triTransformed.p[2], triTransformed.p[0]);
-        normal = Vec3DCrossProduct(line1, line2);
-        normal = Vec3DNormalise(normal);
+    Vec3D light_direction = Vec3DMakef(0.0f, LIGHT_DIRECTION_Y, LIGHT_DIRECTION_Z);
 
-        Vec3D _cameraRay = Vec3DSub(triTransformed.p[0], _camera);
+    box.faces = 0;
 
-        // If ray is aligned with normal, then triangle is visible
-        if (Vec3DDotProduct(normal, _cameraRay) < 0.0f) {
-            Vec3D light_direction = Vec3DMakef(0.0f, 1.0f, -1.0f);
-            light_direction = Vec3DNormalise(light_direction);
+    for (int f = 0; f < 6; f++) {
+        const int* face = s_boxFaces[f];
 
-            float dp = std::max(0.1f, Vec3DDotProduct(light_direction, normal));
-            triTransformed.bright = GetBrightness(dp);
-            triTransformed.color = mesh.color;
-            
-            // Convert World Space --> View Space
-            triViewed.p[0] = MatrixMultiplyVector(_matView, triTransformed.p[0]);
-            triViewed.p[1] = MatrixMultiplyVector(_matView, triTransformed.p[1]);
-            triViewed.p[2] = MatrixMultiplyVector(_matView, triTransformed.p[2]);
-            triViewed.bright = triTransformed.bright;
-            triViewed.color = triTransformed.color;
-
-            // Clip Viewed Triangle against near plane
-            int nClippedTriangles = 0;
-            Triangle clipped[2];
-            nClippedTriangles = TriangleClipAgainstPlane(Vec3DMakef(0.0f, 0.0f, 0.1f), Vec3DMakef(0.0f, 0.0f, 1.0f), triViewed, clipped[0], clipped[1]);
-
-            // We may end up with multiple triangles form the clip, so project as required
-            for (int n = 0; n < nClippedTriangles; n++) {
-                // Project triangles from 3D --> 2D
-                triProjected.p[0] = MatrixMultiplyVector(_matProj, clipped[n].p[0]);
-                triProjected.p[1] = MatrixMultiplyVector(_matProj, clipped[n].p[1]);
-                triProjected.p[2] = MatrixMultiplyVector(_matProj, clipped[n].p[2]);
-                triProjected.bright = clipped[n].bright;
-                triProjected.color = clipped[n].color;
-
-                // Scale into view, we moved the normalising into cartesian space
-                // out of the matrix.vector function from the previous videos, so do this manually
-                triProjected.p[0] = Vec3DDiv(triProjected.p[0], triProjected.p[0].w);
-                triProjected.p[1] = Vec3DDiv(triProjected.p[1], triProjected.p[1].w);
-                triProjected.p[2] = Vec3DDiv(triProjected.p[2], triProjected.p[2].w);
-
-                // X/Y are inverted so put them back
-                triProjected.p[0].x *= -1.0f;
-                triProjected.p[1].x *= -1.0f;
-                triProjected.p[2].x *= -1.0f;
-                triProjected.p[0].y *= -1.0f;
-                triProjected.p[1].y *= -1.0f;
-                triProjected.p[2].y *= -1.0f;
-
-                // Offset verts into visible normalised space
-                Vec3D vOffsetView = Vec3DMakef(1.0f, 1.0f, 0.0f);
-                triProjected.p[0] = Vec3DAdd(triProjected.p[0], vOffsetView);
-                triProjected.p[1] = Vec3DAdd(triProjected.p[1], vOffsetView);
-                triProjected.p[2] = Vec3DAdd(triProjected.p[2], vOffsetView);
-                triProjected.p[0].x *= 0.5f * (float)_screenWidth;
-                triProjected.p[0].y *= 0.5f * (float)_screenHeight;
-                triProjected.p[1].x *= 0.5f * (float)_screenWidth;
-                triProjected.p[1].y *= 0.5f * (float)_screenHeight;
-                triProjected.p[2].x *= 0.5f * (float)_screenWidth;
-                triProjected.p[2].y *= 0.5f * (float)_screenHeight;
-
-                // Save drawing flag
-                triProjected.h = tri.h;
-
-                // Store triangle for sorting
-                vecTrianglesToRaster.push_back(triProjected);
+        // Same visibility test as Transform()
+        Vec3D cameraRay = Vec3DSub(world[face[0]], camera);
+        if (Vec3DDotProduct(instance.normals[f], cameraRay) >= 0.0f) {
+            continue;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            if (!(projected & (1 << face[i]))) {
+                box.screen[face[i]] = ProjectToScreen(world[face[i]]);
+                projected |= 1 << face[i];
             }
         }
+
+        float dp = std::max(0.1f, Vec3DDotProduct(light_direction, instance.normals[f]));
+        box.bright[f] = GetBrightness(dp);
+        box.faces |= 1 << f;
     }
+}
 
-    // Sort triangles from back to front
-    sort(vecTrianglesToRaster.begin(), vecTrianglesToRaster.end(), [](Triangle &t1, Triangle &t2) {
-        float z1 = (t1.p[0].z + t1.p[1].z + t1.p[2].z) / 3.0f;
-        float z2 = (t2.p[0].z + t2.p[1].z + t2.p[2].z) / 3.0f;
-        return z1 > z2;
-    });
+void GameEngine::DrawProjectedBox(BoxProjection& box, byte color) {
+    Vec3D* screen = box.screen;
+    uint64_t edges = 0;
+
+    for (int f = 0; f < 6; f++) {
+        const int* face = s_boxFaces[f];
+
+        if (!(box.faces & (1 << f))) {
+            continue;
+        }
+
+        if (_filled) {
+            FillTriangle(screen[face[0]].x, screen[face[0]].y, screen[face[1]].x, screen[face[1]].y, screen[face[2]].x, screen[face[2]].y, color, box.bright[f]);
+            FillTriangle(screen[face[0]].x, screen[face[0]].y, screen[face[2]].x, screen[face[2]].y, screen[face[3]].x, screen[face[3]].y, color, box.bright[f]);
+            continue;
+        }
+
+        // Edges shared by two visible faces are drawn once
+        for (int i = 0; i < 4; i++) {
+            int c1 = std::min(face[i], face[(i + 1) & 3]);
+            int c2 = std::max(face[i], face[(i + 1) & 3]);
+            uint64_t bit = (uint64_t)1 << (c1 * 8 + c2);
+
+            if (!(edges & bit)) {
+                edges |= bit;
+                DrawEdge(screen[c1], screen[c2], color);
+            }
+        }
+    }
+}
+
+// MARK: - Static chunks
+
+// Reuse the oldest chunk which is not part of the game anymore, memory stays the same for any level length
+StaticChunk* GameEngine::NewChunk() {
+    for (int i = 0; i < CHUNK_RING_SIZE; i++) {
+        int index = (_chunkNext + i) % CHUNK_RING_SIZE;
+        StaticChunk* chunk = &_chunks[index];
+
+        if (!HasGameObject(chunk->GetGameObject())) {
+            _chunkNext = (index + 1) % CHUNK_RING_SIZE;
+            chunk->Clear();
+            return chunk;
+        }
+    }
+
+    // All chunks in use, drop the oldest one
+    RBLOG("GameEngine: Chunk ring full, oldest chunk removed");
+
+    StaticChunk* chunk = &_chunks[_chunkNext];
+    _chunkNext = (_chunkNext + 1) % CHUNK_RING_SIZE;
+
+    RemoveGameObject(chunk->GetGameObject());
+    chunk->Clear();
+
+    return chunk;
 }
 
-void GameEngine::DrawMesh(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, byte color) {
-    std::vector<Triangle>vecTrianglesToRaster;
+// Merge the boxes of the chunk and add it as one game object placed at the chunk origin
+GameObject* GameEngine::AddChunk(StaticChunk* chunk, int tag) {
+    if (chunk->IsEmpty()) {
+        return nullptr;
+    }
+
+    chunk->Build();
+
+    // Chunks are placed like any other world-static object
+
+    GameObject* gameObject = chunk->GetGameObject();
+    if (gameObject == nullptr) {
+        gameObject = new GameObject(chunk, tag);
+        chunk->SetGameObject(gameObject);
+    }
+
+    gameObject->SetTag(tag);
+    gameObject->SetMeshChanged();
+    gameObject->SetAlive();
+    gameObject->SetHidden(false);
+    gameObject->SetPosition(chunk->GetOrigin());
+    gameObject->SetRotation(0, 0, 0);
+    gameObject->SetSpeed(0, 0, 0);
+    gameObject->SetRotationSpeed(0, 0, 0);
+
+    AddStaticGameObject(gameObject);
+
+    return gameObject;
+}
+
+// The position is given in world space, it gets converted into level space once
+void GameEngine::AddStaticGameObject(GameObject* object) {
+    object->SetPosition(Vec3DSub(object->GetPosition(), _scroll));
+    object->SetStatic(true);
+
+    AddGameObject(object);
+}
+
+// The entity of the object joins the live ones, it is drawn after all objects added before
+void GameEngine::AddGameObject(GameObject* object) {
+    if (object->IsAdded()) {
+        return;
+    }
+
+    object->SetAdded(true);
+    _broadPhase.Add(object);
+}
+
+void GameEngine::RemoveGameObject(GameObject* object) {
+    if (!HasGameObject(object)) {
+        return;
+    }
+
+    _broadPhase.Remove(object);
+    ReleaseGameObject(object);
+}
+
+// Objects of the pool are reused, all others stay with their owner
+void GameEngine::RemoveGameObjects() {
+    int live = _entities.GetLiveCount();
+    _entities.DetachAll();
+
+    for (int i = 0; i < live; i++) {
+        ReleaseGameObject(_entities.owners[i]);
+    }
+
+    _broadPhase.Clear();
+}
+
+// The object left the engine, its entity leaves the live ones and its lifetime ends with it
+void GameEngine::ReleaseGameObject(GameObject* object) {
+    object->SetAdded(false);
+
+    if (object->GetLifeTimer() != TIMER_NONE) {
+        _timers.Cancel(object->GetLifeTimer());
+        object->SetLifeTimer(TIMER_NONE);
+    }
+
+    _pool.Release(object);
+}
+
+// The object dies after the given time, replaces an earlier lifetime. Only for objects in the engine
+void GameEngine::SetLifeTime(GameObject* object, float seconds) {
+    _timers.Cancel(object->GetLifeTimer());
+    object->SetLifeTimer(_timers.Add(seconds, [object]() {
+        object->SetLifeTimer(TIMER_NONE);
+        object->SetDead();
+    }));
+}
+
+bool GameEngine::HasGameObject(GameObject* object) {
+    if (object == nullptr) {
+        return false;
+    }
+
+    return object->IsAdded();
+}
+
+// MARK: - Stereo
+
+// Eye matrices of the frame, render x grows against the view x axis (see ProjectViewed()),
+// so the left eye sits on the +x side of the camera
+void GameEngine::UpdateStereoViews() {
+    Vec3D right = Vec3DMakef(_matView.m[0][0], _matView.m[1][0], _matView.m[2][0]);
+
+    for (int v = 0; v < STEREO_VIEWS; v++) {
+        StereoView& view = _stereoViews[v];
+        view.offset = (v == STEREO_LEFT ? 0.5f : -0.5f) * _eyeDistance;
+
+        Mat4x4 matEye = MatrixMakeTranslation(-view.offset, 0.0f, 0.0f);
+        Vec3D shift = Vec3DMul(right, view.offset);
+
+        view.matView = MatrixMultiplyMatrix(_matView, matEye);
+        view.matViewStatic = MatrixMultiplyMatrix(_matViewStatic, matEye);
+        view.camera = Vec3DAdd(_camera, shift);
+        view.cameraStatic = Vec3DSub(view.camera, _scroll);
+        view.lines.clear();
+    }
+}
+
+// The eyes only differ by a shift along the view x axis, so an object is transformed into
+// view space once for both, each eye only culls, projects and clips it
+void GameEngine::DrawStereo(GameObject* gameObject) {
+    Mesh& mesh = *gameObject->GetMesh();
+    Vec3D& pos = gameObject->GetPosition();
+    Vec3D& rot = gameObject->GetRotation();
+    Vec3D& scale = gameObject->GetScale();
+    byte color = gameObject->GetColor();
+
+    _drawStatic = gameObject->IsStatic();
+
+    Vec3D center;
+    float radius = GetViewSphere(mesh, pos, rot, scale, center);
+    int visibility[STEREO_VIEWS];
+    bool inside = true;
+    bool outside = true;
+
+    for (int v = 0; v < STEREO_VIEWS; v++) {
+        Vec3D viewed = center;
+        viewed.x -= _stereoViews[v].offset;
+        visibility[v] = ClassifySphere(viewed, radius);
+
+        inside = inside && visibility[v] == FRUSTUM_INSIDE;
+        outside = outside && visibility[v] == FRUSTUM_OUTSIDE;
+    }
+
+    if (outside) {
+        _drawStatic = false;
+        return;
+    }
+
     mesh.color = color;
-    Transform(vecTrianglesToRaster, mesh, pos, rot, scale);
-    ClipAndDraw(vecTrianglesToRaster, color);
+
+    if (mesh.box && inside) {
+        BoxInstance& instance = GetBoxInstance(rot, scale);
+        Vec3D world[8];
+        BoxProjection box;
+
+        for (int i = 0; i < 8; i++) {
+            world[i] = MatrixMultiplyVector(_matWorld, instance.corners[i]);
+            world[i] = Vec3DAdd(world[i], pos);
+        }
+
+        for (int v = 0; v < STEREO_VIEWS; v++) {
+            _view = &_stereoViews[v];
+            ProjectBoxCorners(instance, world, box);
+            DrawProjectedBox(box, color);
+        }
+    }
+    else {
+        if (mesh.normals.size() != mesh.GetTriangleCount()) {
+            mesh.UpdateNormals();
+        }
+
+        for (int v = 0; v < STEREO_VIEWS; v++) {
+            _stereoViews[v].tris.clear();
+        }
+
+        // Both eyes use the same clip stage, clipping is only skipped if both see all of the object
+        if (inside) {
+            if (mesh.quantised) TransformStereo<ClipNone, VerticesQuantised>(mesh, pos, rot, scale);
+            else TransformStereo<ClipNone, VerticesFloat>(mesh, pos, rot, scale);
+        }
+        else {
+            if (mesh.quantised) TransformStereo<ClipFrustum, VerticesQuantised>(mesh, pos, rot, scale);
+            else TransformStereo<ClipFrustum, VerticesFloat>(mesh, pos, rot, scale);
+        }
+
+        for (int v = 0; v < STEREO_VIEWS; v++) {
+            _view = &_stereoViews[v];
+
+            if (visibility[v] == FRUSTUM_OUTSIDE) continue;
+
+            if (inside) RasterWith<FillWireframe, ClipNone, OutputScreen>(_view->tris);
+            else RasterWith<FillWireframe, ClipFrustum, OutputScreen>(_view->tris);
+        }
+    }
+
+    _view = nullptr;
+    _drawStatic = false;
+}
+
+// Wireframe kernel of both eyes, see TransformMesh(), vertices of faces seen by any eye
+// are transformed once with the view of the camera and shifted for each eye
+template <class Clip, class Vertices>
+void GameEngine::TransformStereo(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale) {
+    Mat4x4 matInverse;
+    Mat4x4 matModelView = BuildModelView(pos, rot, scale, matInverse);
+    Vec3D cofactors = Vec3DMakef(scale.y * scale.z, scale.x * scale.z, scale.x * scale.y);
+    Vec3D eyes[STEREO_VIEWS];
+
+    for (int v = 0; v < STEREO_VIEWS; v++) {
+        _view = &_stereoViews[v];
+        eyes[v] = MatrixMultiplyVector(matInverse, GetViewCamera());
+    }
+
+    _view = nullptr;
+
+    size_t count = mesh.GetTriangleCount();
+
+    for (size_t i = 0; i < count; i++) {
+        Vec3D p0 = Vertices::Get(mesh, i, 0);
+        Vec3D normal = Vec3DMakef(mesh.normals[i].x * cofactors.x, mesh.normals[i].y * cofactors.y, mesh.normals[i].z * cofactors.z);
+        bool visible[STEREO_VIEWS];
+        bool any = false;
+
+        for (int v = 0; v < STEREO_VIEWS; v++) {
+            Vec3D cameraRay = Vec3DMakef(p0.x * scale.x - eyes[v].x, p0.y * scale.y - eyes[v].y, p0.z * scale.z - eyes[v].z);
+            visible[v] = Vec3DDotProduct(normal, cameraRay) < 0.0f;
+            any = any || visible[v];
+        }
+
+        if (!any) {
+            continue;
+        }
+
+        Triangle triViewed;
+        Vec3D p1 = Vertices::Get(mesh, i, 1);
+        Vec3D p2 = Vertices::Get(mesh, i, 2);
+        triViewed.p[0] = MatrixMultiplyVector(matModelView, p0);
+        triViewed.p[1] = MatrixMultiplyVector(matModelView, p1);
+        triViewed.p[2] = MatrixMultiplyVector(matModelView, p2);
+        triViewed.color = Vertices::Color(mesh, i);
+        triViewed.bright = BRIGHTNESS_OFF;
+
+        for (int v = 0; v < STEREO_VIEWS; v++) {
+            if (!visible[v]) {
+                continue;
+            }
+
+            Triangle triEye = triViewed;
+            triEye.p[0].x -= _stereoViews[v].offset;
+            triEye.p[1].x -= _stereoViews[v].offset;
+            triEye.p[2].x -= _stereoViews[v].offset;
+
+            ProjectTriangle<Clip>(triEye, Vertices::Hide(mesh, i), _stereoViews[v].tris);
+        }
+    }
+}
+
+// One view after the other, the 3D Imager shows each to one eye while its wheel turns
+void GameEngine::DrawStereoViews() {
+    for (int v = 0; v < STEREO_VIEWS; v++) {
+        platform_set_view(v == STEREO_LEFT ? VIEW_LEFT : VIEW_RIGHT);
+
+        for (auto &line : _stereoViews[v].lines) {
+            platform_draw_line(line.x1, line.y1, line.x2, line.y2, line.color, INVERT_OFF);
+        }
+    }
+
+    platform_set_view(VIEW_BOTH);
+}
+
+// MARK: - Particles
+
+// Debris flying apart from pos (world space), it stays at its place in the level while the world scrolls
+void GameEngine::AddExplosion(Vec3D pos, byte color) {
+    Vec3D level = Vec3DSub(pos, _scroll);
+    Vec3D velocity = Vec3DMakeZero();
+
+    _particles.Emit(level, velocity, PARTICLE_EXPLOSION_COUNT, PARTICLE_EXPLOSION_SPEED, PARTICLE_EXPLOSION_LIFETIME, color);
+}
+
+// All particles in one batch after the objects, projected with the view of world-static objects.
+// The world matrix comes first, like BuildModel() applies it to the objects the debris came from
+void GameEngine::DrawParticles() {
+    int views = _stereo ? STEREO_VIEWS : 1;
+
+    _drawStatic = true;
+
+    for (int v = 0; v < views; v++) {
+        _view = _stereo ? &_stereoViews[v] : nullptr;
+
+        Mat4x4 matView = MatrixMultiplyMatrix(_matWorld, GetViewMatrix());
+        int segments = _particles.Project(matView, _matProj, (float)_renderWidth, (float)_renderHeight);
+
+        for (int n = 0; n < segments; n++) {
+            Vec3D p1, p2;
+            byte color;
+
+            _particles.GetSegment(n, p1, p2, color);
+            DrawEdge(p1, p2, color);
+        }
+    }
+
+    _view = nullptr;
+    _drawStatic = false;
+}
+
+// MARK: - Projectiles
+
+// Position and velocity in world space, returns the index of the projectile or -1 if too many are in flight
+int GameEngine::FireProjectile(Vec3D pos, Vec3D velocity, float lifetime, byte color, int tag) {
+    Vec3D level = Vec3DSub(pos, _scroll);
+    Vec3D levelVelocity = Vec3DSub(velocity, _scrollSpeed);
+
+    return _projectiles.Fire(level, levelVelocity, lifetime, color, tag);
+}
+
+// One vector along the flight direction, centered where the bullet model used to be. The world
+// matrix comes first, like BuildModel() applies it to the objects which fire and get hit
+void GameEngine::DrawProjectiles() {
+    int views = _stereo ? STEREO_VIEWS : 1;
+
+    _drawStatic = true;
+
+    for (int v = 0; v < views; v++) {
+        _view = _stereo ? &_stereoViews[v] : nullptr;
+
+        Mat4x4 matView = MatrixMultiplyMatrix(_matWorld, GetViewMatrix());
+
+        for (int i = 0; i < _projectiles.GetCount(); i++) {
+            Projectile& p = _projectiles.Get(i);
+
+            if (!_projectiles.IsAlive(i)) {
+                continue;
+            }
+
+            // Without a velocity in the level the vector points along z, the way the game fires
+            Vec3D dir = Vec3DMakef(0.0f, 0.0f, 1.0f);
+            if (Vec3DLength(p.velocity) > 0.0f) {
+                dir = Vec3DNormalise(p.velocity);
+            }
+
+            Vec3D half = Vec3DMul(dir, PROJECTILE_LENGTH * 0.5f);
+            Vec3D head = Vec3DAdd(p.pos, half);
+            Vec3D tail = Vec3DSub(p.pos, half);
+
+            head = MatrixMultiplyVector(matView, head);
+            tail = MatrixMultiplyVector(matView, tail);
+
+            // Near plane
+            if (head.z < 0.1f || tail.z < 0.1f) {
+                continue;
+            }
+
+            head = ProjectViewed(head);
+            tail = ProjectViewed(tail);
+            DrawEdge(head, tail, p.color);
+        }
+    }
+
+    _view = nullptr;
+    _drawStatic = false;
+}
+
+// MARK: - Collisions
+
+// Object pairs and projectile hits of the tags paired by SetCollisionMask(), valid until the next call
+std::vector<Collision>& GameEngine::FindCollisions() {
+    _broadPhase.Find(_entities, _projectiles, _scroll, _collisions);
+
+    return _collisions;
+}
+
+// MARK: - Occlusion culling
+
+// The large boxes of all visible chunks are rasterised into the occlusion buffer, once per frame
+void GameEngine::BuildOcclusion() {
+    _occlusion.Clear(_renderWidth, _renderHeight);
+
+    for (int c = 0; c < CHUNK_RING_SIZE; c++) {
+        StaticChunk& chunk = _chunks[c];
+        GameObject* gameObject = chunk.GetGameObject();
+
+        if (chunk.IsEmpty() || !HasGameObject(gameObject) || gameObject->IsDead() || gameObject->IsHidden()) {
+            continue;
+        }
+
+        Vec3D& pos = gameObject->GetPosition();
+        Vec3D& rot = gameObject->GetRotation();
+        Vec3D& scale = gameObject->GetScale();
+
+        _drawStatic = gameObject->IsStatic();
+
+        if (ClassifyMesh(*chunk.GetMesh(), pos, rot, scale) == FRUSTUM_OUTSIDE) {
+            _drawStatic = false;
+            continue;
+        }
+
+        Mat4x4 matInverse;
+        Mat4x4 matModelView = BuildModelView(pos, rot, scale, matInverse);
+
+        for (auto &box : chunk.GetBoxes()) {
+            if (!box.occluder) {
+                continue;
+            }
+
+            Vec3D viewed[8];
+            Vec3D screen[8];
+            bool behind = false;
+
+            for (int i = 0; i < 8 && !behind; i++) {
+                Vec3D corner = Vec3DMakef(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z);
+                viewed[i] = MatrixMultiplyVector(matModelView, corner);
+                behind = viewed[i].z < 0.1f;
+            }
+
+            // Boxes crossing the near plane are not used
+            if (behind) {
+                continue;
+            }
+
+            for (int i = 0; i < 8; i++) {
+                screen[i] = ProjectViewed(viewed[i]);
+            }
+
+            // All faces, a face hides the same as the box behind it (depth is the farthest corner)
+            for (int f = 0; f < 6; f++) {
+                Vec3D quad[4];
+                float depth = 0.0f;
+
+                for (int i = 0; i < 4; i++) {
+                    quad[i] = screen[s_boxFaces[f][i]];
+                    depth = std::max(depth, viewed[s_boxFaces[f][i]].z);
+                }
+
+                _occlusion.AddQuad(quad, depth);
+            }
+        }
+
+        _drawStatic = false;
+    }
+
+    _occlusionStats.occluders += _occlusion.GetOccluderCount();
+}
+
+// Screen rectangle of the bounding sphere against the occlusion buffer
+bool GameEngine::IsOccluded(GameObject* gameObject) {
+    if (_occlusion.GetOccluderCount() == 0) {
+        return false;
+    }
+
+    _drawStatic = gameObject->IsStatic();
+
+    Vec3D center;
+    float radius = GetViewSphere(*gameObject->GetMesh(), gameObject->GetPosition(), gameObject->GetRotation(), gameObject->GetScale(), center);
+
+    _drawStatic = false;
+
+    if (center.z - radius < 0.1f) {
+        return false;
+    }
+
+    // Screen bounds of the cube around the sphere, each side is widest at the near or far face
+    float zNear = center.z - radius;
+    float zFar = center.z + radius;
+    float x0 = center.x - radius, x1 = center.x + radius;
+    float y0 = center.y - radius, y1 = center.y + radius;
+    float ndcMinX = _matProj.m[0][0] * x0 / (x0 < 0.0f ? zNear : zFar);
+    float ndcMaxX = _matProj.m[0][0] * x1 / (x1 > 0.0f ? zNear : zFar);
+    float ndcMinY = _matProj.m[1][1] * y0 / (y0 < 0.0f ? zNear : zFar);
+    float ndcMaxY = _matProj.m[1][1] * y1 / (y1 > 0.0f ? zNear : zFar);
+
+    // x and y are flipped, see ProjectViewed()
+    float minX = (1.0f - ndcMaxX) * 0.5f * (float)_renderWidth;
+    float maxX = (1.0f - ndcMinX) * 0.5f * (float)_renderWidth;
+    float minY = (1.0f - ndcMaxY) * 0.5f * (float)_renderHeight;
+    float maxY = (1.0f - ndcMinY) * 0.5f * (float)_renderHeight;
+
+    return _occlusion.IsOccluded(minX, minY, maxX, maxY, zNear);
 }
 
 // MARK: - World and camera matrix
@@ -421,8 +1442,13 @@ void GameEngine::BuildWorldMatrix() {
     Mat4x4 matTrans;
     matTrans = MatrixMakeTranslation(0.0f, 0.0f, 5.0f);
 
-    _matWorld = MatrixMakeIdentity();
-    _matWorld = MatrixMultiplyMatrix(_matWorld, matTrans);
+    Mat4x4 matWorld = MatrixMakeIdentity();
+    matWorld = MatrixMultiplyMatrix(matWorld, matTrans);
+
+    if (memcmp(&matWorld, &_matWorld, sizeof(Mat4x4)) != 0) {
+        _matWorld = matWorld;
+        _viewVersion++;
+    }
 }
 
 void GameEngine::UpdateCamera(float fYaw) {
@@ -433,7 +1459,44 @@ void GameEngine::UpdateCamera(float fYaw) {
     
     vTarget = Vec3DAdd(_camera, _lookDir);
     Mat4x4 matCamera = MatrixPointAt(_camera, vTarget, vUp);
-    _matView = MatrixQuickInverse(matCamera);
+    Mat4x4 matView = MatrixQuickInverse(matCamera);
+
+    // Called each frame, cached projections stay valid while the camera doesn't move
+    if (memcmp(&matView, &_matView, sizeof(Mat4x4)) != 0) {
+        _matView = matView;
+        _viewVersion++;
+    }
+}
+
+void GameEngine::UpdateStaticView() {
+    Mat4x4 matScroll = MatrixMakeTranslation(_scroll.x, _scroll.y, _scroll.z);
+    Mat4x4 matViewStatic = MatrixMultiplyMatrix(matScroll, _matView);
+
+    if (memcmp(&matViewStatic, &_matViewStatic, sizeof(Mat4x4)) != 0) {
+        _matViewStatic = matViewStatic;
+        _staticViewVersion++;
+    }
+
+    _cameraStatic = Vec3DSub(_camera, _scroll);
+
+    GameObject::SetScroll(_scroll);
+}
+
+// Static objects keep their place relative to the world, only the offset gets cleared
+void GameEngine::ResetScroll() {
+    for (int i = 0; i < _entities.GetLiveCount(); i++) {
+        if (_entities.flags[i] & ENTITY_STATIC) {
+            _entities.position[i] = Vec3DAdd(_entities.position[i], _scroll);
+            _entities.modelVersion[i]++;
+        }
+    }
+
+    _scroll = Vec3DMakeZero();
+    UpdateStaticView();
+
+    // Particles and projectiles are short lived, they are not moved along
+    _particles.Clear();
+    _projectiles.Clear();
 }
 
 // MARK: - Controls
@@ -497,7 +1560,10 @@ bool GameEngine::Init(char* name, int width, int height, bool filled) {
 
     _screenWidth = width;
     _screenHeight = height;
+    _renderWidth = width;
+    _renderHeight = height;
     _filled = filled;
+    SelectRenderPipeline();
     
     // Initialise controls
     for (int i = 0; i < MAX_CONTROLS; i++) {
@@ -580,33 +1646,92 @@ void GameEngine::Frame() {
     deltaTime /= 1000.0f;
     
     platform_on_frame(deltaTime);
+
+    int renderWidth = _renderWidth;
+    int renderHeight = _renderHeight;
+    platform_get_render_size(&_renderWidth, &_renderHeight);
+
+    if (renderWidth != _renderWidth || renderHeight != _renderHeight) {
+        _viewVersion++;
+    }
     
     bool result = OnUpdate(deltaTime);
 
-    for (auto gameObject : m_gameObjects) {
-        if (!gameObject->IsDead()) {
-            
-            if (result) {
-                if (_autoUpdate) {
-                    gameObject->Update(deltaTime);
-                }
-            }
-            
-            if (!gameObject->IsHidden()) {
-                DrawMesh(*gameObject->GetMesh(), gameObject->GetPosition(), gameObject->GetRotation(), gameObject->GetScale(), gameObject->GetColor());
-            }
+    // Scrolling moves all world-static objects at once
+    if (result && _autoUpdate) {
+        _scroll.x += _scrollSpeed.x * deltaTime;
+        _scroll.y += _scrollSpeed.y * deltaTime;
+        _scroll.z += _scrollSpeed.z * deltaTime;
+
+        // Timers first, objects whose lifetime ends are no longer moved or drawn
+        _timers.Advance(deltaTime);
+
+        // Moving objects, in the order of the entity store
+        _entities.Update(deltaTime);
+
+        _particles.Update(deltaTime);
+        _projectiles.Update(deltaTime);
+    }
+
+    UpdateStaticView();
+    SelectRenderPipeline();
+
+    if (_stereo) {
+        UpdateStereoViews();
+    }
+    else if (_occlusionCulling) {
+        BuildOcclusion();
+        _occlusionStats.frames++;
+        _occlusionStats.culledFrame = 0;
+    }
+
+    // Visible live entities, drawn in the order their objects were added
+    _drawOrder.clear();
+
+    for (int i = 0; i < _entities.GetLiveCount(); i++) {
+        if (!(_entities.flags[i] & (ENTITY_DEAD | ENTITY_HIDDEN))) {
+            _drawOrder.push_back(i);
         }
     }
-    
-    // TODO: Remove dead objects
-    int size = (int)m_gameObjects.size();
-    
-    for (int i = size-1; i >= 0; i--) {
-        if (m_gameObjects.at(i)->IsDead()) {
-            m_gameObjects.erase(m_gameObjects.begin()+i);
+
+    std::vector<unsigned int>& order = _entities.order;
+    std::sort(_drawOrder.begin(), _drawOrder.end(), [&order](int a, int b) {
+        return order[a] < order[b];
+    });
+
+    for (int n : _drawOrder) {
+        GameObject* gameObject = _entities.owners[n];
+
+        if (_stereo) {
+            DrawStereo(gameObject);
+        }
+        else if (_occlusionCulling && IsOccluded(gameObject)) {
+            _occlusionStats.culled++;
+            _occlusionStats.culledFrame++;
         }
+        else {
+            DrawGameObject(gameObject);
+        }
+    }
+
+    DrawParticles();
+    DrawProjectiles();
+
+    if (_stereo) {
+        DrawStereoViews();
     }
+    
+    // Dead objects leave the engine, pooled ones are reused by the next spawn. The live entities stay dense
+    int live = _entities.GetLiveCount();
+    int count = _entities.DetachDead();
 
+    if (count != live) {
+        for (int i = count; i < live; i++) {
+            ReleaseGameObject(_entities.owners[i]);
+        }
+
+        _broadPhase.RemoveDead();
+    }
 }
 
 int GameEngine::GetBrightness(float lum) {    
@@ -10,10 +10,35 @@
 
 #include "rb_math.hpp"
 #include "rb_mesh.hpp"
+#include "rb_chunk.hpp"
+#include "rb_collision.hpp"
+#include "rb_object.hpp"
+#include "rb_occlusion.hpp"
+#include "rb_particles.hpp"
+#include "rb_pool.hpp"
+#include "rb_projectiles.hpp"
+#include "rb_timers.hpp"
 #include "rb_types.hpp"
 
 #include <vector>
 
+// Triangles reaching this far (render pixels) outside the screen are scissored, not clipped
+#define CLIP_GUARD_BAND     64.0f
+
+// Object classification against the view frustum
+#define FRUSTUM_OUTSIDE     0
+#define FRUSTUM_INTERSECT   1
+#define FRUSTUM_INSIDE      2
+
+// Number of scale/rotation combinations of boxes kept transformed
+#define BOX_INSTANCE_CACHE  16
+
+// Stereo output for the 3D Imager, views are drawn in the order of the eyes
+#define STEREO_VIEWS        2
+#define STEREO_LEFT         0
+#define STEREO_RIGHT        1
+#define STEREO_EYE_DISTANCE 0.5f    // World units between the eyes
+
 #define COLOR_MODE_AUTO     -1
 #define COLOR_MODE_RED      -2
 
@@ -49,6 +74,63 @@ enum COLOR {
 
 enum CONTROLSTATE { ctrlUndefined, ctrlPressed, ctrlHold, ctrlReleased };
 
+// Box corners and face normals after scale and rotation, shared by boxes with the same values
+struct BoxInstance {
+    Vec3D scale;
+    Vec3D rot;
+    Vec3D corners[8];
+    Vec3D normals[6];
+};
+
+// Vertex of a mesh in edge mode, transformed once per draw, see GameEngine::TransformEdges()
+struct EdgeVertex {
+    Vec3D viewed;
+    Vec3D screen;
+    bool done;
+};
+
+// Projection cache usage, see GameEngine::DrawGameObject()
+struct CacheStats {
+    long hits = 0;
+    long misses = 0;
+    long trianglesReused = 0;
+};
+
+// Line in render coordinates, see GameEngine::DrawStereoViews()
+struct VectorLine {
+    float x1, y1;
+    float x2, y2;
+    byte color;
+};
+
+// One eye of the stereo output, offset from the camera along the view x axis
+struct StereoView {
+    float offset;                       // View space x of the eye
+    Mat4x4 matView;
+    Mat4x4 matViewStatic;
+    Vec3D camera;
+    Vec3D cameraStatic;
+    std::vector<Triangle> tris;         // Projected triangles of the object drawn
+    std::vector<VectorLine> lines;      // Drawn after all objects, one view after the other
+};
+
+// Objects hidden behind level walls, see GameEngine::IsOccluded()
+struct OcclusionStats {
+    long frames = 0;
+    long culled = 0;
+    long occluders = 0;         // Faces in the occlusion buffer
+    int culledFrame = 0;        // Objects culled in the last frame
+};
+
+class GameEngine;
+
+// Both stages of one render pipeline, instantiated from the policies in rb_pipeline.hpp
+struct RenderVariant {
+    const char* name;
+    void (GameEngine::*transform)(std::vector<Triangle>&, Mesh&, Vec3D&, Vec3D&, Vec3D&);
+    int (GameEngine::*raster)(std::vector<Triangle>&);
+};
+
 typedef struct CONTROL_TAG {
     CONTROLSTATE state;
     float stateTime;
@@ -56,8 +138,6 @@ typedef struct CONTROL_TAG {
 
 VecRGB GetPaletteColor(byte color, int brightness);
 
-class GameObject;
-
 class GameEngine {
 public:
     GameEngine();
@@ -69,10 +149,75 @@ public:
     void DrawLine(int x1, int y1, int x2, int y2, byte color);
     void DrawTriangle(Vec3D& vec1, Vec3D& vec2, Vec3D& vec3, byte color, int number);
     void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, uint8_t paletteColor, int brightness);
-    void Transform(std::vector<Triangle>& vecTrianglesToRaster, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale);
     void Clip(int& x, int& y);
-    void ClipAndDraw(std::vector<Triangle>& vecTrianglesToRaster, byte color);
-    void DrawMesh(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, byte color);
+    int ClassifyMesh(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale);
+    void DrawMesh(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, byte color, bool isStatic = false, ProjectionCache* cache = nullptr);
+    void DrawGameObject(GameObject* gameObject);
+    void TransformEdges(std::vector<Vec3D>& lines, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, bool clip = true);
+    void DrawLines(std::vector<Vec3D>& lines, byte color);
+    void DrawBox(Vec3D& pos, Vec3D& rot, Vec3D& scale, byte color);
+    void ProjectBox(Vec3D& pos, Vec3D& rot, Vec3D& scale, BoxProjection& box);
+    void ProjectBoxCorners(BoxInstance& instance, Vec3D* world, BoxProjection& box);
+    void DrawProjectedBox(BoxProjection& box, byte color);
+
+// Stereo
+public:
+    void UpdateStereoViews();
+    void DrawStereo(GameObject* gameObject);
+    void DrawStereoViews();
+
+private:
+    template <class Clip, class Vertices> void TransformStereo(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale);
+
+// Particles
+public:
+    void AddExplosion(Vec3D pos, byte color);
+    void DrawParticles();
+    ParticleSystem& GetParticles() { return _particles; }
+
+// Projectiles
+public:
+    int FireProjectile(Vec3D pos, Vec3D velocity, float lifetime, byte color, int tag = 0);
+    void RemoveProjectile(int n) { _projectiles.Remove(n); }
+    bool IsProjectileAlive(int n) { return _projectiles.IsAlive(n); }
+    void DrawProjectiles();
+    ProjectileSystem& GetProjectiles() { return _projectiles; }
+
+// Timers, they run with the scrolling, see SetAutoUpdate()
+public:
+    int AddTimer(float seconds, std::function<void()> callback) { return _timers.Add(seconds, callback); }
+    int AddRepeatingTimer(float interval, std::function<void()> callback) { return _timers.AddRepeating(interval, callback); }
+    bool CancelTimer(int timer) { return _timers.Cancel(timer); }
+    void SetLifeTime(GameObject* object, float seconds);
+
+// Collisions
+public:
+    void SetCollisionMask(int tag, unsigned int mask) { _broadPhase.SetMask(tag, mask); }
+    std::vector<Collision>& FindCollisions();
+    CollisionStats GetCollisionStats() { return _broadPhase.GetStats(); }
+    void ResetCollisionStats() { _broadPhase.GetStats() = CollisionStats(); }
+
+// Occlusion culling
+public:
+    void BuildOcclusion();
+    bool IsOccluded(GameObject* gameObject);
+
+// Render pipeline
+public:
+    template <class Lighting, class Sort, class Clip> void TransformWith(std::vector<Triangle>& vecTrianglesToRaster, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale);
+    template <class Fill, class Clip, class Output> int RasterWith(std::vector<Triangle>& vecTrianglesToRaster);
+    void SelectRenderPipeline();
+    const RenderVariant& GetRenderVariant(int visibility);
+    void BenchmarkPipelines(int frames);
+
+private:
+    template <class Lighting, class Clip, class Vertices> void TransformMesh(std::vector<Triangle>& vecTrianglesToRaster, Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale);
+    template <class Clip> void ProjectTriangle(Triangle& triViewed, int hide, std::vector<Triangle>& vecTrianglesToRaster);
+
+// Static chunks
+public:
+    StaticChunk* NewChunk();
+    GameObject* AddChunk(StaticChunk* chunk, int tag = 0);
     
 // Text
 public:
@@ -83,6 +228,7 @@ public:
 public:
     void BuildWorldMatrix();
     void UpdateCamera(float fYaw);
+    void UpdateStaticView();
 
 // Lifeycle
 public:
@@ -112,14 +258,36 @@ public:
 
 // Getter/Setter
 public:
-    void AddGameObject(GameObject* object) { m_gameObjects.push_back(object); }
-    void RemoveGameObjects() { m_gameObjects.clear(); }
+    GameObject* NewGameObject(int type, int tag = 0) { return _pool.New(GameObject::GetPrimitive(type), type, tag); }
+    GameObject* NewGameObject(Mesh* mesh, int tag = 0) { return _pool.New(mesh, GAME_OBJECT_TYPE_MESH, tag); }
+    void AddGameObject(GameObject* object);
+    void AddStaticGameObject(GameObject* object);
+    void RemoveGameObject(GameObject* object);
+    bool HasGameObject(GameObject* object);
+    void RemoveGameObjects();
+    PoolStats GetPoolStats() { return _pool.GetStats(); }
+
+    // Objects in the engine, in no particular order. Removing one moves the last one into its place
+    int GetGameObjectCount() { return _entities.GetLiveCount(); }
+    GameObject* GetGameObject(int n) { return _entities.GetOwner(n); }
+
+private:
+    void ReleaseGameObject(GameObject* object);
+
+public:
     
     bool IsFinished() { return _finished; }
     void SetFinished() { _finished = true; }
     int GetScreenWidth() { return _screenWidth; }
     int GetScreenHeight() { return _screenHeight; }
-    void SetProjectionMatrix(Mat4x4& matProj) { _matProj = matProj; }
+    int GetRenderWidth() { return _renderWidth; }
+    int GetRenderHeight() { return _renderHeight; }
+    float GetRenderScale() { return (float)_renderWidth / (float)_screenWidth; }
+    int ToRenderX(int x) { return _renderWidth == _screenWidth ? x : x * _renderWidth / _screenWidth; }
+    int ToRenderY(int y) { return _renderHeight == _screenHeight ? y : y * _renderHeight / _screenHeight; }
+    int GetClipMaxX() { return _renderWidth - 1; }
+    int GetClipMaxY() { return _renderHeight - 1; }
+    void SetProjectionMatrix(Mat4x4& matProj) { _matProj = matProj; _viewVersion++; }
     void SetCameraPos(float x, float y, float z) { _camera.x = x; _camera.y = y; _camera.z = z; }
     void SetCameraPos(Vec3D pos) { _camera.x = pos.x; _camera.y = pos.y; _camera.z = pos.z; }
     void SetCameraPosX(float x) { _camera.x = x; }
@@ -132,20 +300,45 @@ public:
     void ChangeCameraSub(Vec3D vec) { _camera = Vec3DSub(_camera, vec); }
     Vec3D GetCameraPos() { return _camera; }
     Vec3D GetLookDirectionVector() { return _lookDir; }
+    void SetScrollSpeed(float x, float y, float z) { _scrollSpeed = Vec3DMakef(x, y, z); }
+    Vec3D GetScrollSpeed() { return _scrollSpeed; }
+    Vec3D GetScroll() { return _scroll; }
+    void ResetScroll();
 
-    void SetFilled(bool flag) { _filled = flag; }
+    void SetFilled(bool flag) { _filled = flag; _viewVersion++; }
+    void SetEdgeMode(bool flag) { _edgeMode = flag; _viewVersion++; }
+    bool IsEdgeMode() { return _edgeMode; }
     
     void SetAutoUpdate(bool flag) { _autoUpdate = flag; }
 
+    CacheStats GetCacheStats() { return _cacheStats; }
+    void ResetCacheStats() { _cacheStats = CacheStats(); }
+
+    void SetStereo(bool flag) { _stereo = flag; }
+    bool IsStereo() { return _stereo; }
+    void SetEyeDistance(float distance) { _eyeDistance = distance; }
+
+    void SetOcclusionCulling(bool flag) { _occlusionCulling = flag; }
+    bool IsOcclusionCulling() { return _occlusionCulling; }
+    OcclusionStats GetOcclusionStats() { return _occlusionStats; }
+    void ResetOcclusionStats() { _occlusionStats = OcclusionStats(); }
+
 // Helper
 public:
     int GetBrightness(float lum);
+    Mat4x4& GetViewMatrix() { return _view != nullptr ? (_drawStatic ? _view->matViewStatic : _view->matView) : (_drawStatic ? _matViewStatic : _matView); }
+    Vec3D& GetViewCamera() { return _view != nullptr ? (_drawStatic ? _view->cameraStatic : _view->camera) : (_drawStatic ? _cameraStatic : _camera); }
+    BoxInstance& GetBoxInstance(Vec3D& rot, Vec3D& scale);
+    Vec3D ProjectToScreen(Vec3D& world);
+    Vec3D ProjectViewed(Vec3D& viewed);
+    float GetViewSphere(Mesh& mesh, Vec3D& pos, Vec3D& rot, Vec3D& scale, Vec3D& center);
+    int ClassifySphere(Vec3D& center, float radius);
+    Mat4x4 BuildModel(Vec3D& pos, Vec3D& rot, Vec3D& scale, Mat4x4& matInverse);
+    Mat4x4 BuildModelView(Vec3D& pos, Vec3D& rot, Vec3D& scale, Mat4x4& matInverse);
+    void DrawEdge(Vec3D& v1, Vec3D& v2, byte color);
     void ChangeControlState(int code, bool flag, float deltaTime);
     void UpdateControlStates(float deltaTime);
     
-protected:
-    std::vector<GameObject *> m_gameObjects;
-
 private:
     Mat4x4 _matProj;    // Matrix that converts from view space to screen space
     Vec3D _camera;      // Location of camera in world space
@@ -154,13 +347,52 @@ private:
     Mat4x4 _matWorld;
     Mat4x4 _matView;
 
+    // World-static objects never move, the scroll offset moves the view instead
+    Vec3D _scroll;                      // Offset from level space (static objects) to world space
+    Vec3D _scrollSpeed;
+    Mat4x4 _matViewStatic;              // Scroll offset followed by the view matrix
+    Vec3D _cameraStatic;                // Camera location in level space
+    bool _drawStatic = false;           // True while DrawMesh() draws a world-static object
+
+    // Changed whenever the projection of objects changes, keys of the projection cache
+    unsigned int _viewVersion = 0;      // Projection, world and view matrix, render size
+    unsigned int _staticViewVersion = 0;    // Scrolled view matrix of static objects
+    CacheStats _cacheStats;
+
+    const RenderVariant* _renderVariants = nullptr;  // Pipelines of the frame, see SelectRenderPipeline()
+
     int _screenWidth;
     int _screenHeight;
+    int _renderWidth;                   // Current render size (dynamic resolution), projection
+    int _renderHeight;                  // and rasterisation use this instead of the screen size
     double _timer1;
     double _timer2;
     double _frame_last = -1;
     bool _finished;
     bool _filled = false;
+    bool _edgeMode = false;             // Wireframe of loaded models with silhouette and crease edges only
+    std::vector<byte> _frontFaces;      // Facing of the faces, see TransformEdges()
+    std::vector<EdgeVertex> _edgeVertices;
     bool _autoUpdate = true;            // If true then game objects get updated by engine
     CONTROL _controls[MAX_CONTROLS];
+    BoxInstance _boxInstances[BOX_INSTANCE_CACHE];
+    int _boxInstanceCount = 0;
+    int _boxInstanceNext = 0;
+    StaticChunk _chunks[CHUNK_RING_SIZE];   // Ring of static chunks, reused in order
+    int _chunkNext = 0;
+    bool _stereo = false;               // Both eyes for the 3D Imager, wireframe only
+    float _eyeDistance = STEREO_EYE_DISTANCE;
+    StereoView _stereoViews[STEREO_VIEWS];
+    StereoView* _view = nullptr;        // Eye drawn by DrawStereo(), replaces the view matrix and camera
+    EntityStore _entities;              // State of all game objects, see GameObject
+    std::vector<int> _drawOrder;        // Visible live entities of the frame, see Frame()
+    ParticleSystem _particles;          // In level space, like world-static objects
+    ProjectileSystem _projectiles;      // Also in level space
+    GameObjectPool _pool;               // Objects of NewGameObject(), returned when removed or dead
+    TimerWheel _timers;                 // Object lifetimes and timed game events
+    BroadPhase _broadPhase;             // All game objects sorted along z
+    std::vector<Collision> _collisions;
+    bool _occlusionCulling = false;     // Skip objects fully behind large boxes of the chunks
+    OcclusionBuffer _occlusion;
+    OcclusionStats _occlusionStats;
 };
@@ -0,0 +1,178 @@
+//
+//  rb_entities.cpp
+//  3d wireframe game engine: entity store
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_entities.hpp"
+#include "rb_object.hpp"
+
+#include <algorithm>
+
+// MARK: - Entities
+
+int EntityStore::Add(GameObject* owner) {
+    position.push_back(Vec3DMakeZero());
+    rotation.push_back(Vec3DMakeZero());
+    scale.push_back(Vec3DMakeZero());
+    speed.push_back(Vec3DMakeZero());
+    rotationSpeed.push_back(Vec3DMakeZero());
+    color.push_back(-1);
+    modelVersion.push_back(0);
+    flags.push_back(0);
+    order.push_back(0);
+    tag.push_back(0);
+    boundsMin.push_back(Vec3DMakeZero());
+    boundsMax.push_back(Vec3DMakeZero());
+    timer.push_back(TIMER_NONE);
+    owners.push_back(owner);
+
+    int n = GetCount() - 1;
+    Reset(n);
+
+    return n;
+}
+
+// The last entity takes the place of the removed one, its game object gets the new index
+void EntityStore::Remove(int n) {
+    if (IsLive(n)) {
+        Detach(n);
+        n = _live;
+    }
+
+    int last = GetCount() - 1;
+
+    if (n != last) {
+        position[n] = position[last];
+        rotation[n] = rotation[last];
+        scale[n] = scale[last];
+        speed[n] = speed[last];
+        rotationSpeed[n] = rotationSpeed[last];
+        color[n] = color[last];
+        modelVersion[n] = modelVersion[last];
+        flags[n] = flags[last];
+        order[n] = order[last];
+        tag[n] = tag[last];
+        boundsMin[n] = boundsMin[last];
+        boundsMax[n] = boundsMax[last];
+        timer[n] = timer[last];
+        owners[n] = owners[last];
+        owners[n]->_entity = n;
+    }
+
+    position.pop_back();
+    rotation.pop_back();
+    scale.pop_back();
+    speed.pop_back();
+    rotationSpeed.pop_back();
+    color.pop_back();
+    modelVersion.pop_back();
+    flags.pop_back();
+    order.pop_back();
+    tag.pop_back();
+    boundsMin.pop_back();
+    boundsMax.pop_back();
+    timer.pop_back();
+    owners.pop_back();
+}
+
+// State of a new game object, the model version keeps counting so caches never match a reused entity
+void EntityStore::Reset(int n) {
+    position[n] = Vec3DMake(0, 0, 0);
+    rotation[n] = Vec3DMake(0, 0, 0);
+    scale[n] = Vec3DMake(1, 1, 1);
+    speed[n] = Vec3DMake(0, 0, 0);
+    rotationSpeed[n] = Vec3DMake(0, 0, 0);
+    color[n] = -1;
+    flags[n] = ENTITY_BOUNDS_CHANGED;
+    tag[n] = 0;
+    timer[n] = TIMER_NONE;
+}
+
+// MARK: - Live entities
+
+// The object of the entity enters the engine, its entity goes to the end of the live ones and
+// gets the next draw order
+void EntityStore::Attach(int n) {
+    if (!IsLive(n)) {
+        order[n] = _nextOrder++;
+        Swap(n, _live++);
+    }
+}
+
+// The last live entity takes the place of this one
+void EntityStore::Detach(int n) {
+    if (IsLive(n)) {
+        Swap(n, --_live);
+    }
+}
+
+// Dead entities leave the live ones in one pass. Returns the index of the first dead one, the
+// dead are behind it up to the previous live count
+int EntityStore::DetachDead() {
+    for (int i = 0; i < _live; ) {
+        if (flags[i] & ENTITY_DEAD) {
+            Swap(i, --_live);
+            continue;
+        }
+
+        i++;
+    }
+
+    return _live;
+}
+
+void EntityStore::Swap(int a, int b) {
+    std::swap(position[a], position[b]);
+    std::swap(rotation[a], rotation[b]);
+    std::swap(scale[a], scale[b]);
+    std::swap(speed[a], speed[b]);
+    std::swap(rotationSpeed[a], rotationSpeed[b]);
+    std::swap(color[a], color[b]);
+    std::swap(modelVersion[a], modelVersion[b]);
+    std::swap(flags[a], flags[b]);
+    std::swap(order[a], order[b]);
+    std::swap(tag[a], tag[b]);
+    std::swap(boundsMin[a], boundsMin[b]);
+    std::swap(boundsMax[a], boundsMax[b]);
+    std::swap(timer[a], timer[b]);
+    std::swap(owners[a], owners[b]);
+    owners[a]->_entity = a;
+    owners[b]->_entity = b;
+}
+
+// MARK: - Systems
+
+// Moves and rotates the live entities which are neither static nor dead, lifetimes are timers
+void EntityStore::Update(float delta) {
+    for (int i = 0; i < _live; i++) {
+        if ((flags[i] & (ENTITY_STATIC | ENTITY_DEAD)) == 0) {
+            Update(i, delta);
+        }
+    }
+}
+
+void EntityStore::Update(int n, float delta) {
+    Vec3D& s = speed[n];
+
+    if (s.x != 0.0f || s.y != 0.0f || s.z != 0.0f) {
+        Vec3D& p = position[n];
+        p.x += s.x * delta;
+        p.y += s.y * delta;
+        p.z += s.z * delta;
+        modelVersion[n]++;
+    }
+
+    Vec3D& rs = rotationSpeed[n];
+
+    if (rs.x != 0.0f || rs.y != 0.0f || rs.z != 0.0f) {
+        Vec3D& r = rotation[n];
+        r.x += rs.x * delta;
+        r.y += rs.y * delta;
+        r.z += rs.z * delta;
+        modelVersion[n]++;
+        flags[n] |= ENTITY_BOUNDS_CHANGED;
+    }
+}
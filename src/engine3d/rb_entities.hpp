@@ -0,0 +1,85 @@
+//
+//  rb_entities.hpp
+//  3d wireframe game engine: entity store
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_math.hpp"
+#include "rb_timers.hpp"
+
+#include <vector>
+
+// State bits of an entity
+#define ENTITY_STATIC           0x01    // Never moves in level space, see GameEngine::AddStaticGameObject()
+#define ENTITY_HIDDEN           0x02
+#define ENTITY_DEAD             0x04
+#define ENTITY_BOUNDS_CHANGED   0x08    // Bounds need an update, see GameObject::GetLocalMin()
+
+class BroadPhase;
+class GameEngine;
+class GameObject;
+
+// State of all game objects, one array per component. A game object is a handle with the index of
+// its entity, the index changes when entities are moved. Entities of the objects in the engine are
+// kept in front, a removed one is replaced by the last of them. The systems walk only those, see
+// GetLiveCount(). The arrays belong to the game objects and the systems of the engine
+class EntityStore {
+    friend class BroadPhase;
+    friend class GameEngine;
+    friend class GameObject;
+
+public:
+    EntityStore() {}
+
+    int Add(GameObject* owner);
+    void Remove(int n);
+    void Reset(int n);
+    int GetCount() { return (int)owners.size(); }
+
+    void Attach(int n);
+    void Detach(int n);
+    void DetachAll() { _live = 0; }
+    int DetachDead();
+    bool IsLive(int n) { return n < _live; }
+    int GetLiveCount() { return _live; }
+    GameObject* GetOwner(int n) { return owners[n]; }
+
+    void Update(float delta);
+    void Update(int n, float delta);
+
+private:
+    void Swap(int a, int b);
+
+private:
+    // Transform
+    std::vector<Vec3D> position;
+    std::vector<Vec3D> rotation;
+    std::vector<Vec3D> scale;
+
+    // Velocity
+    std::vector<Vec3D> speed;
+    std::vector<Vec3D> rotationSpeed;
+
+    // Render
+    std::vector<int> color;
+    std::vector<unsigned int> modelVersion;     // Changed with position, rotation, scale, color or mesh
+    std::vector<unsigned char> flags;
+    std::vector<unsigned int> order;            // Draw order, counts up with each object added to the engine
+
+    // Collision
+    std::vector<int> tag;
+    std::vector<Vec3D> boundsMin;               // Mesh bounds after scale and rotation
+    std::vector<Vec3D> boundsMax;
+
+    // Lifetime
+    std::vector<int> timer;                     // Kills the object, see GameEngine::SetLifeTime()
+
+    std::vector<GameObject*> owners;
+
+    int _live = 0;                              // Entities of objects in the engine
+    unsigned int _nextOrder = 0;
+};
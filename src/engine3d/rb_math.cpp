@@ -9,6 +9,7 @@
 #include "rb_math.hpp"
 #include "rb_base.h"
 #include <string.h>
+#include <algorithm>
 
 Vec3D Vec3DMakeZero() {
     return Vec3D(0.0f, 0.0f, 0.0f);
@@ -172,6 +173,144 @@ int TriangleClipAgainstPlane(Vec3D plane_p, Vec3D plane_n, Triangle &in_tri, Tri
     return 0;
 }
 
+int Vec3DOutcode(Vec3D &v, float xmin, float ymin, float xmax, float ymax) {
+    int code = OUTCODE_INSIDE;
+
+    if (v.x < xmin) code |= OUTCODE_LEFT;
+    else if (v.x > xmax) code |= OUTCODE_RIGHT;
+    if (v.y < ymin) code |= OUTCODE_BOTTOM;
+    else if (v.y > ymax) code |= OUTCODE_TOP;
+
+    return code;
+}
+
+bool LineClipAgainstRect(float &x1, float &y1, float &x2, float &y2, float xmin, float ymin, float xmax, float ymax) {
+    // Cohen-Sutherland, move the outside end point onto the crossed edge until both are inside
+    Vec3D p1 = Vec3DMakef(x1, y1, 0.0f);
+    Vec3D p2 = Vec3DMakef(x2, y2, 0.0f);
+    int code1 = Vec3DOutcode(p1, xmin, ymin, xmax, ymax);
+    int code2 = Vec3DOutcode(p2, xmin, ymin, xmax, ymax);
+
+    while (code1 | code2) {
+        if (code1 & code2) {
+            return false;
+        }
+
+        int code = code1 ? code1 : code2;
+        float x, y;
+
+        if (code & OUTCODE_TOP) {
+            x = x1 + (x2 - x1) * (ymax - y1) / (y2 - y1);
+            y = ymax;
+        }
+        else if (code & OUTCODE_BOTTOM) {
+            x = x1 + (x2 - x1) * (ymin - y1) / (y2 - y1);
+            y = ymin;
+        }
+        else if (code & OUTCODE_RIGHT) {
+            y = y1 + (y2 - y1) * (xmax - x1) / (x2 - x1);
+            x = xmax;
+        }
+        else {
+            y = y1 + (y2 - y1) * (xmin - x1) / (x2 - x1);
+            x = xmin;
+        }
+
+        if (code == code1) {
+            x1 = x; y1 = y;
+            p1 = Vec3DMakef(x1, y1, 0.0f);
+            code1 = Vec3DOutcode(p1, xmin, ymin, xmax, ymax);
+        }
+        else {
+            x2 = x; y2 = y;
+            p2 = Vec3DMakef(x2, y2, 0.0f);
+            code2 = Vec3DOutcode(p2, xmin, ymin, xmax, ymax);
+        }
+    }
+
+    return true;
+}
+
+bool SegmentIntersectsBox(Vec3D &p1, Vec3D &p2, Vec3D &min, Vec3D &max) {
+    // Slab test, the part of the segment inside of all three slabs must not be empty
+    float start[3] = { p1.x, p1.y, p1.z };
+    float delta[3] = { p2.x - p1.x, p2.y - p1.y, p2.z - p1.z };
+    float lo[3] = { min.x, min.y, min.z };
+    float hi[3] = { max.x, max.y, max.z };
+    float tmin = 0.0f;
+    float tmax = 1.0f;
+
+    for (int axis = 0; axis < 3; axis++) {
+        if (fabsf(delta[axis]) < 0.00001f) {
+            if (start[axis] < lo[axis] || start[axis] > hi[axis]) {
+                return false;
+            }
+
+            continue;
+        }
+
+        float t1 = (lo[axis] - start[axis]) / delta[axis];
+        float t2 = (hi[axis] - start[axis]) / delta[axis];
+
+        if (t1 > t2) {
+            float t = t1; t1 = t2; t2 = t;
+        }
+
+        tmin = t1 > tmin ? t1 : tmin;
+        tmax = t2 < tmax ? t2 : tmax;
+
+        if (tmin > tmax) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// One edge of the Sutherland-Hodgman clipper, points with (coordinate - limit) * side >= 0 are inside
+static int PolygonClipEdge(Vec3D* in, int count, Vec3D* out, bool vertical, float limit, float side) {
+    int n = 0;
+
+    for (int i = 0; i < count; i++) {
+        Vec3D& a = in[i];
+        Vec3D& b = in[i + 1 < count ? i + 1 : 0];
+        float da = ((vertical ? a.x : a.y) - limit) * side;
+        float db = ((vertical ? b.x : b.y) - limit) * side;
+
+        if (da >= 0.0f) {
+            out[n++] = a;
+        }
+
+        if ((da >= 0.0f) != (db >= 0.0f)) {
+            float t = da / (da - db);
+            out[n++] = Vec3DMakef(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+        }
+    }
+
+    return n;
+}
+
+// Clips a convex polygon (room for POLYGON_CLIP_MAX_VERTICES) in place, only the edges
+// flagged in codes (outcodes of all vertices or'ed) are tested, returns the number of vertices
+int PolygonClipAgainstRect(Vec3D* polygon, int count, int codes, float xmin, float ymin, float xmax, float ymax) {
+    Vec3D temp[POLYGON_CLIP_MAX_VERTICES];
+    Vec3D* in = polygon;
+    Vec3D* out = temp;
+
+    if (codes & OUTCODE_BOTTOM) { count = PolygonClipEdge(in, count, out, false, ymin, 1.0f); std::swap(in, out); }
+    if (codes & OUTCODE_TOP) { count = PolygonClipEdge(in, count, out, false, ymax, -1.0f); std::swap(in, out); }
+    if (codes & OUTCODE_LEFT) { count = PolygonClipEdge(in, count, out, true, xmin, 1.0f); std::swap(in, out); }
+    if (codes & OUTCODE_RIGHT) { count = PolygonClipEdge(in, count, out, true, xmax, -1.0f); std::swap(in, out); }
+
+    if (in != polygon) {
+        for (int i = 0; i < count; i++) {
+            polygon[i] = in[i];
+        }
+    }
+
+    return count;
+}
+
 Vec3D MatrixMultiplyVector(Mat4x4 &m, Vec3D &i) {
     Vec3D v;
     v.x = i.x * m.m[0][0] + i.y * m.m[1][0] + i.z * m.m[2][0] + i.w * m.m[3][0];
@@ -29,6 +29,24 @@ float Vec3DAngle(Vec3D& vec1, Vec3D& vec2);
 
 int TriangleClipAgainstPlane(Vec3D plane_p, Vec3D plane_n, Triangle &in_tri, Triangle &out_tri1, Triangle &out_tri2);
 
+// Screen outcodes, a bit is set for each edge of the rectangle a point lies outside of
+#define OUTCODE_INSIDE  0
+#define OUTCODE_LEFT    1
+#define OUTCODE_RIGHT   2
+#define OUTCODE_BOTTOM  4
+#define OUTCODE_TOP     8
+
+int Vec3DOutcode(Vec3D &v, float xmin, float ymin, float xmax, float ymax);
+bool LineClipAgainstRect(float &x1, float &y1, float &x2, float &y2, float xmin, float ymin, float xmax, float ymax);
+
+// True if the segment from p1 to p2 touches the axis aligned box
+bool SegmentIntersectsBox(Vec3D &p1, Vec3D &p2, Vec3D &min, Vec3D &max);
+
+// Room needed by PolygonClipAgainstRect(), each edge adds at most one vertex to a triangle
+#define POLYGON_CLIP_MAX_VERTICES   9
+
+int PolygonClipAgainstRect(Vec3D* polygon, int count, int codes, float xmin, float ymin, float xmax, float ymax);
+
 Vec3D MatrixMultiplyVector(Mat4x4 &m, Vec3D &i);
 Mat4x4 MatrixMakeZero();
 Mat4x4 MatrixMakeIdentity();
@@ -11,10 +11,20 @@
 #include "rb_platform.h"
 #include "rb_log.h"
 #include "rb_file.hpp"
+#include "rb_base.h"
 
 #include <fstream>
 #include <strstream>
 #include <algorithm>
+#include <map>
+#include <tuple>
+
+#define MESH_DEGENERATED_AREA   0.000001f
+
+// Grid steps of a 16 bit coordinate
+#define MESH_QUANTISE_STEPS     65534.0f
+
+MeshMemory Mesh::s_memory;
 
 bool Mesh::LoadObjectFile(std::string filename) {
     FileReader reader;
@@ -23,6 +33,9 @@ bool Mesh::LoadObjectFile(std::string filename) {
     }
 
     std::vector<Vec3D> verts;
+    std::vector<int> indices;
+    std::vector<int> welded;        // First vertex with the same position, models repeat vertices per face
+    std::map<std::tuple<float, float, float>, int> positions;
 
     while (!reader.Eof()) {
         std::string line = reader.ReadLine();
@@ -36,17 +49,205 @@ bool Mesh::LoadObjectFile(std::string filename) {
                 Vec3D v;
                 s >> junk >> v.x >> v.y >> v.z;
                 verts.push_back(v);
+
+                auto it = positions.insert(std::make_pair(std::make_tuple(v.x, v.y, v.z), (int)welded.size())).first;
+                welded.push_back(it->second);
             }
 
             if (line[0] == 'f') {
                 int f[3];
                 s >> junk >> f[0] >> f[1] >> f[2];
                 tris.push_back({ verts[f[0] - 1], verts[f[1] - 1], verts[f[2] - 1] });
+                indices.insert(indices.end(), { welded[f[0] - 1], welded[f[1] - 1], welded[f[2] - 1] });
             }
         }
     }
     
     RBLOG_NUM1("Model loaded (# of tris)", tris.size());
 
+    long floatBytes = (long)(tris.size() * sizeof(Triangle));
+    s_memory.models++;
+
+    if (Quantise()) {
+        long bytes = (long)(quantisedTris.size() * sizeof(QuantisedTriangle));
+        s_memory.quantised++;
+        s_memory.bytes += bytes;
+        s_memory.bytesSaved += floatBytes - bytes;
+
+        RBLOG_NUM1(" Quantised (bytes saved)", (int)(floatBytes - bytes));
+    }
+    else {
+        s_memory.bytes += floatBytes;
+    }
+
+    UpdateBounds();
+    UpdateNormals();
+    UpdateEdges(indices);
+
+    RBLOG_NUM1(" Edges", (int)edges.size());
+
+    return true;
+}
+
+// Store the vertices as 16 bit values on a grid over the bounding box, if no vertex
+// moves by more than maxError. Triangles with own colors or hidden lines are never quantised
+bool Mesh::Quantise(float maxError) {
+    if (quantised || tris.empty() || triangleColors) {
+        return false;
+    }
+
+    Vec3D min = tris[0].p[0];
+    Vec3D max = tris[0].p[0];
+
+    for (auto &tri : tris) {
+        if (tri.h != 0) {
+            return false;
+        }
+
+        for (int i = 0; i < 3; i++) {
+            min.x = std::min(min.x, tri.p[i].x); max.x = std::max(max.x, tri.p[i].x);
+            min.y = std::min(min.y, tri.p[i].y); max.y = std::max(max.y, tri.p[i].y);
+            min.z = std::min(min.z, tri.p[i].z); max.z = std::max(max.z, tri.p[i].z);
+        }
+    }
+
+    // Grid value 0 is the center of the bounding box
+    Vec3D size = Vec3DSub(max, min);
+    quantScale = Vec3DMakef(size.x > 0.0f ? size.x / MESH_QUANTISE_STEPS : 1.0f,
+                            size.y > 0.0f ? size.y / MESH_QUANTISE_STEPS : 1.0f,
+                            size.z > 0.0f ? size.z / MESH_QUANTISE_STEPS : 1.0f);
+    quantOffset = Vec3DMakef((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f);
+
+    std::vector<QuantisedTriangle> result(tris.size());
+    float error = 0.0f;
+
+    for (size_t t = 0; t < tris.size(); t++) {
+        for (int i = 0; i < 3; i++) {
+            Vec3D& v = tris[t].p[i];
+            int16_t* q = result[t].p[i];
+
+            q[0] = (int16_t)std::max(-32767.0f, std::min(32767.0f, roundf((v.x - quantOffset.x) / quantScale.x)));
+            q[1] = (int16_t)std::max(-32767.0f, std::min(32767.0f, roundf((v.y - quantOffset.y) / quantScale.y)));
+            q[2] = (int16_t)std::max(-32767.0f, std::min(32767.0f, roundf((v.z - quantOffset.z) / quantScale.z)));
+
+            Vec3D w = Dequantise(q);
+            Vec3D d = Vec3DSub(w, v);
+            error = std::max(error, std::max(fabsf(d.x), std::max(fabsf(d.y), fabsf(d.z))));
+        }
+    }
+
+    if (error > maxError) {
+        return false;
+    }
+
+    quantisedTris.swap(result);
+    quantised = true;
+
+    std::vector<Triangle>().swap(tris);
+
     return true;
 }
+
+void Mesh::UpdateBounds() {
+    size_t count = GetTriangleCount();
+
+    if (count == 0) {
+        center = Vec3DMakeZero();
+        radius = 0.0f;
+        boundsMin = Vec3DMakeZero();
+        boundsMax = Vec3DMakeZero();
+        return;
+    }
+
+    // Center of the bounding box, radius to the farthest vertex
+    Vec3D min = GetVertex(0, 0);
+    Vec3D max = min;
+
+    for (size_t t = 0; t < count; t++) {
+        for (int i = 0; i < 3; i++) {
+            Vec3D v = GetVertex(t, i);
+            min.x = std::min(min.x, v.x); max.x = std::max(max.x, v.x);
+            min.y = std::min(min.y, v.y); max.y = std::max(max.y, v.y);
+            min.z = std::min(min.z, v.z); max.z = std::max(max.z, v.z);
+        }
+    }
+
+    center = Vec3DMakef((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f);
+    radius = 0.0f;
+    boundsMin = min;
+    boundsMax = max;
+
+    for (size_t t = 0; t < count; t++) {
+        for (int i = 0; i < 3; i++) {
+            Vec3D v = GetVertex(t, i);
+            Vec3D d = Vec3DSub(v, center);
+            radius = std::max(radius, Vec3DLength(d));
+        }
+    }
+}
+
+// Same normal and light as calculated by GameEngine::Transform() before, once per mesh
+void Mesh::UpdateNormals() {
+    size_t count = GetTriangleCount();
+    normals.resize(count);
+    light.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        Vec3D p0 = GetVertex(i, 0);
+        Vec3D p1 = GetVertex(i, 1);
+        Vec3D p2 = GetVertex(i, 2);
+        Vec3D line1 = Vec3DSub(p1, p0);
+        Vec3D line2 = Vec3DSub(p2, p0);
+        Vec3D normal = Vec3DCrossProduct(line1, line2);
+        float length = Vec3DLength(normal);
+
+        // Degenerated triangles never face the camera
+        normals[i] = length > MESH_DEGENERATED_AREA ? Vec3DDiv(normal, length) : Vec3DMakeZero();
+        light[i] = std::max(0.1f, normals[i].y * LIGHT_DIRECTION_Y + normals[i].z * LIGHT_DIRECTION_Z);
+    }
+}
+
+// Edge to face adjacency from the vertex indices of the faces (three per face), needs the normals.
+// Edges shared by more than two faces are split into several edges
+void Mesh::UpdateEdges(std::vector<int>& indices) {
+    std::map<std::pair<int, int>, size_t> lookup;
+    float creaseCos = cosf(DEG_TO_RAD(MESH_CREASE_ANGLE));
+
+    edges.clear();
+    vertexCount = 0;
+
+    for (size_t face = 0; face * 3 + 2 < indices.size(); face++) {
+        for (int corner = 0; corner < 3; corner++) {
+            int v1 = indices[face * 3 + corner];
+            int v2 = indices[face * 3 + (corner + 1) % 3];
+            std::pair<int, int> key(std::min(v1, v2), std::max(v1, v2));
+
+            auto it = lookup.find(key);
+            if (it != lookup.end() && edges[it->second].face[1] < 0) {
+                edges[it->second].face[1] = (int)face;
+                continue;
+            }
+
+            MeshEdge edge;
+            edge.face[0] = (int)face;
+            edge.face[1] = -1;
+            edge.corner = corner;
+            edge.vertex[0] = v1;
+            edge.vertex[1] = v2;
+            edge.crease = true;
+
+            vertexCount = std::max(vertexCount, std::max(v1, v2) + 1);
+
+            lookup[key] = edges.size();
+            edges.push_back(edge);
+        }
+    }
+
+    for (auto &edge : edges) {
+        if (edge.face[1] >= 0) {
+            Vec3D& n1 = normals[edge.face[0]];
+            Vec3D& n2 = normals[edge.face[1]];
+            edge.crease = Vec3DDotProduct(n1, n2) < creaseCos;
+        }
+    }
+}
@@ -12,12 +12,79 @@
 
 #include <vector>
 #include <string>
+#include <stdint.h>
+
+// Fixed light of the engine, (0, 1, -1) normalised
+#define LIGHT_DIRECTION_Y    0.70710678f
+#define LIGHT_DIRECTION_Z   -0.70710678f
+
+// Largest position error (object units) accepted for 16 bit vertices, see Mesh::Quantise()
+#define MESH_QUANTISE_ERROR  0.001f
+
+// Adjacent faces meeting at a larger angle (degrees) are drawn in edge mode
+#define MESH_CREASE_ANGLE    30.0f
 
 // MARK: - Mesh data
 
+// Vertex positions on a 16 bit grid, position = p * quantScale + quantOffset of the mesh
+struct QuantisedTriangle {
+    int16_t p[3][3];
+};
+
+// Edge from corner to corner + 1 of face[0], face[1] is the other face or -1 on open borders
+struct MeshEdge {
+    int face[2];
+    int corner;
+    int vertex[2];          // Index of the corners among all distinct vertices
+    bool crease;            // Dihedral angle above MESH_CREASE_ANGLE
+};
+
+// Edges drawn in edge mode compared to the edges of a full wireframe, see GameEngine::TransformEdges()
+struct EdgeStats {
+    long draws = 0;
+    long edgesDrawn = 0;
+    long wireframeEdges = 0;    // Three per front face
+};
+
+// Vertex storage of all loaded models
+struct MeshMemory {
+    long models = 0;
+    long quantised = 0;
+    long bytes = 0;             // Size of the vertex storage
+    long bytesSaved = 0;        // Compared to float vertices
+};
+
 struct Mesh {
     std::vector<Triangle> tris;
     byte color;
-    
+    Vec3D center;           // Bounding sphere in object space, radius < 0 until calculated
+    float radius = -1.0f;
+    Vec3D boundsMin;        // Bounding box in object space, see GameObject::UpdateBounds()
+    Vec3D boundsMax;
+    bool box = false;       // Unit cube (0..1) built by GameObject, drawn by GameEngine::DrawBox()
+    bool triangleColors = false;    // Triangles keep their own color (merged chunks), else color of mesh
+    std::vector<Vec3D> normals;     // Face normals in object space, one per triangle
+    std::vector<float> light;       // Light of each face for an unrotated object with uniform scale
+    std::vector<QuantisedTriangle> quantisedTris;   // Replaces tris of quantised meshes
+    Vec3D quantScale;
+    Vec3D quantOffset;
+    bool quantised = false;
+    std::vector<MeshEdge> edges;    // Adjacency of loaded models, empty for other meshes
+    int vertexCount = 0;            // Distinct vertices of the edges
+    EdgeStats edgeStats;
+
     bool LoadObjectFile(std::string filename);
+    bool Quantise(float maxError = MESH_QUANTISE_ERROR);
+    void UpdateBounds();
+    void UpdateNormals();
+    void UpdateEdges(std::vector<int>& indices);
+
+    size_t GetTriangleCount() { return quantised ? quantisedTris.size() : tris.size(); }
+    Vec3D GetVertex(size_t tri, int i) { return quantised ? Dequantise(quantisedTris[tri].p[i]) : tris[tri].p[i]; }
+    Vec3D Dequantise(const int16_t* q) { return Vec3D(q[0] * quantScale.x + quantOffset.x, q[1] * quantScale.y + quantOffset.y, q[2] * quantScale.z + quantOffset.z); }
+
+    static MeshMemory& GetMemory() { return s_memory; }
+
+private:
+    static MeshMemory s_memory;
 };
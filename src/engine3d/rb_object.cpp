@@ -7,115 +7,222 @@
 //
 
 #include "rb_object.hpp"
+#include "rb_chunk.hpp"
 #include "rb_log.h"
 
 #include <float.h>
+#include <algorithm>
 
 static int object_counter = 0;
 Mesh* GameObject::s_cube = nullptr;
+Mesh* GameObject::s_rectangle = nullptr;
+Vec3D GameObject::s_scroll;
+EntityStore* GameObject::s_entities = nullptr;
 
 GameObject::GameObject(int type, int tag) {
+    _entity = s_entities->Add(this);
     Initialise();
+    SetTag(tag);
 
     _type = type;
-    _tag = tag;
-    
-    if (_type == GAME_OBJECT_TYPE_CUBE) {
-        if (s_cube == nullptr) {
-            s_cube = new Mesh();
-            s_cube->tris = PrimtiveGetCube();
-        }
-    
-        _mesh = s_cube;
-    }
-    else if (_type == GAME_OBJECT_TYPE_RECTANGLE) {
-        _mesh = new Mesh();
-        _mesh->tris = PrimtiveGetRectangle();
-    }
-    else {
-        RBLOG("Unknow game object type");
-    }
+    _mesh = GetPrimitive(type);
 }
 
 GameObject::GameObject(std::string name, int tag) {
+    _entity = s_entities->Add(this);
     Initialise();
+    SetTag(tag);
 
     _type = GAME_OBJECT_TYPE_MESH;
-    _tag = tag;
 
     _mesh = new Mesh();
     _mesh->LoadObjectFile(name);
 }
 
 GameObject::GameObject(Mesh* mesh, int tag) {
+    _entity = s_entities->Add(this);
     Initialise();
+    SetTag(tag);
 
     _type = GAME_OBJECT_TYPE_MESH;
-    _tag = tag;
 
     _mesh = mesh;
 }
 
+GameObject::GameObject(StaticChunk* chunk, int tag) {
+    _entity = s_entities->Add(this);
+    Initialise();
+    SetTag(tag);
+
+    _type = GAME_OBJECT_TYPE_CHUNK;
+
+    _chunk = chunk;
+    _mesh = chunk->GetMesh();
+}
+
+// The last entity takes over the index of this one. Objects outliving the engine have no store left
+GameObject::~GameObject() {
+    if (s_entities != nullptr) {
+        s_entities->Remove(_entity);
+    }
+}
+
+// Meshes of the primitives are shared by all objects of the type
+Mesh* GameObject::GetPrimitive(int type) {
+    if (type == GAME_OBJECT_TYPE_CUBE) {
+        if (s_cube == nullptr) {
+            s_cube = new Mesh();
+            s_cube->tris = PrimtiveGetCube();
+            s_cube->UpdateBounds();
+            s_cube->UpdateNormals();
+            s_cube->box = true;
+        }
+
+        return s_cube;
+    }
+    else if (type == GAME_OBJECT_TYPE_RECTANGLE) {
+        if (s_rectangle == nullptr) {
+            s_rectangle = new Mesh();
+            s_rectangle->tris = PrimtiveGetRectangle();
+            s_rectangle->UpdateBounds();
+            s_rectangle->UpdateNormals();
+        }
+
+        return s_rectangle;
+    }
+
+    RBLOG("Unknow game object type");
+    return nullptr;
+}
+
+// Same state as a new object, the projection cache keeps its memory, see GameObjectPool
+void GameObject::Reset(Mesh* mesh, int type, int tag) {
+    Initialise();
+    SetTag(tag);
+
+    _type = type;
+    _mesh = mesh;
+}
+
 void GameObject::Initialise() {
     _id = ++object_counter;
+    _mesh = nullptr;
+    _chunk = nullptr;
+    _isPlayer = false;
+    _cache.valid = false;
 
-    _isHidden = false;
-    _color = -1;
-    _isDead = false;
-    _lifetime = FLT_MAX;
-    _elapsed = 0;
-    
-    _position = Vec3DMake(0, 0, 0);
-    _scale = Vec3DMake(1, 1, 1);
-    _rotation = Vec3DMake(0, 0, 0);
-
-    _speed = Vec3DMake(0, 0, 0);
-    _rotationSpeed = Vec3DMake(0, 0, 0);
+    s_entities->Reset(_entity);
 }
 
-void GameObject::Update(float delta) {
-    _position.x += _speed.x * delta;
-    _position.y += _speed.y * delta;
-    _position.z += _speed.z * delta;
+// Box around the corners of the mesh bounds, scaled and rotated like GameEngine::BuildModel() does
+void GameObject::UpdateBounds() {
+    Vec3D& rotation = GetRotation();
+    Vec3D& scale = GetScale();
+    Vec3D& boundsMin = s_entities->boundsMin[_entity];
+    Vec3D& boundsMax = s_entities->boundsMax[_entity];
+    SetFlag(ENTITY_BOUNDS_CHANGED, false);
 
-    _rotation.x += _rotationSpeed.x * delta;
-    _rotation.y += _rotationSpeed.y * delta;
-    _rotation.z += _rotationSpeed.z * delta;
-    
-    _elapsed += delta;
-    if (_elapsed > _lifetime) {
-        SetDead();
+    if (_mesh == nullptr) {
+        boundsMin = Vec3DMakeZero();
+        boundsMax = scale;
+        return;
+    }
+
+    if (_mesh->radius < 0.0f) {
+        _mesh->UpdateBounds();
+    }
+
+    Vec3D& min = _mesh->boundsMin;
+    Vec3D& max = _mesh->boundsMax;
+    bool rotated = rotation.x != 0.0f || rotation.y != 0.0f || rotation.z != 0.0f;
+    Mat4x4 matRot = MatrixMakeIdentity();
+
+    if (rotated) {
+        Mat4x4 matRotX = MatrixMakeRotationX(rotation.x);
+        Mat4x4 matRotY = MatrixMakeRotationY(rotation.y);
+        Mat4x4 matRotZ = MatrixMakeRotationZ(rotation.z);
+        matRot = MatrixMultiplyMatrix(matRotX, matRotY);
+        matRot = MatrixMultiplyMatrix(matRot, matRotZ);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        Vec3D corner = Vec3DMakef((i & 1 ? max.x : min.x) * scale.x, (i & 2 ? max.y : min.y) * scale.y, (i & 4 ? max.z : min.z) * scale.z);
+
+        if (rotated) {
+            corner = MatrixMultiplyVector(matRot, corner);
+        }
+
+        if (i == 0) {
+            boundsMin = corner;
+            boundsMax = corner;
+            continue;
+        }
+
+        boundsMin.x = std::min(boundsMin.x, corner.x); boundsMax.x = std::max(boundsMax.x, corner.x);
+        boundsMin.y = std::min(boundsMin.y, corner.y); boundsMax.y = std::max(boundsMax.y, corner.y);
+        boundsMin.z = std::min(boundsMin.z, corner.z); boundsMax.z = std::max(boundsMax.z, corner.z);
     }
 }
 
+void GameObject::GetBounds(Vec3D& min, Vec3D& max) {
+    Vec3D pos = GetWorldPosition();
+
+    min = Vec3DAdd(pos, GetLocalMin());
+    max = Vec3DAdd(pos, GetLocalMax());
+}
+
 bool GameObject::IsColliding(GameObject& other) {
-    return (
-        GetMinX() <= other.GetMaxX() &&
-        GetMaxX() >= other.GetMinX() &&
-        GetMinY() <= other.GetMaxY() &&
-        GetMaxY() >= other.GetMinY() &&
-        GetMinZ() <= other.GetMaxZ() &&
-        GetMaxZ() >= other.GetMinZ()
+    Vec3D min, max, otherMin, otherMax;
+    GetBounds(min, max);
+    other.GetBounds(otherMin, otherMax);
+
+    bool colliding = (
+        min.x <= otherMax.x &&
+        max.x >= otherMin.x &&
+        min.y <= otherMax.y &&
+        max.y >= otherMin.y &&
+        min.z <= otherMax.z &&
+        max.z >= otherMin.z
     );
+
+    // Chunk bounds passed, now test its boxes
+    if (colliding && other._chunk != nullptr) {
+        Vec3D pos = other.GetWorldPosition();
+        return other._chunk->IsColliding(*this, pos);
+    }
+
+    if (colliding && _chunk != nullptr) {
+        Vec3D pos = GetWorldPosition();
+        return _chunk->IsColliding(other, pos);
+    }
+
+    return colliding;
 }
 
 void GameObject::Dump() {
+    EntityStore& entities = *s_entities;
+    Vec3D& position = entities.position[_entity];
+    Vec3D& rotation = entities.rotation[_entity];
+    Vec3D& scale = entities.scale[_entity];
+    Vec3D& speed = entities.speed[_entity];
+    Vec3D& rotationSpeed = entities.rotationSpeed[_entity];
+    int color = entities.color[_entity];
+
     if (_isPlayer)
         printf("Player: %d\n", _id);
     else
-        printf("Game object: %d (%d)\n", _id, _tag);
+        printf("Game object: %d (%d)\n", _id, GetTag());
 
     printf("- AABB: %.2f,%.2f|%.2f,%.2f|%.2f,%.2f\n", GetMinX(), GetMaxX(), GetMinY(), GetMaxY(), GetMinZ(), GetMaxZ());
-    printf("- Position: %.2f,%.2f,%.2f (SP %.2f,%.2f,%.2f)\n", _position. x, _position.y, _position.z, _speed.x, _speed.y, _speed.z);
-    printf("- Rotation: %.2f,%.2f,%.2f (RSP %.2f,%.2f,%.2f)\n", _rotation. x, _rotation.y, _rotation.z, _rotationSpeed.x, _rotationSpeed.y, _rotationSpeed.z);
-    printf("- Scale: %.3f,%3f,%3f\n", _scale.x, _scale.y, _scale.z);
+    printf("- Position: %.2f,%.2f,%.2f (SP %.2f,%.2f,%.2f)\n", position. x, position.y, position.z, speed.x, speed.y, speed.z);
+    if (IsStatic())
+        printf("- Static: %.2f,%.2f,%.2f in world\n", GetMinX(), GetMinY(), GetMinZ());
+    printf("- Rotation: %.2f,%.2f,%.2f (RSP %.2f,%.2f,%.2f)\n", rotation. x, rotation.y, rotation.z, rotationSpeed.x, rotationSpeed.y, rotationSpeed.z);
+    printf("- Scale: %.3f,%3f,%3f\n", scale.x, scale.y, scale.z);
     
-    if (_lifetime >= FLT_MAX)
-        printf("- Lifetime: %.3f (%d)\n", _elapsed, _isDead);
-    else
-        printf("- Lifetime: %.3f of %.3f (%d)\n", _elapsed, _lifetime, _isDead);
+    printf("- Lifetime: %s (%d)\n", entities.timer[_entity] == TIMER_NONE ? "unlimited" : "timer", IsDead());
 
-    printf("- Color: %s (%d)\n", _color == -1 ? "automatic" : "fix", _color);
+    printf("- Color: %s (%d)\n", color == -1 ? "automatic" : "fix", color);
     printf("- Type: %d\n\n", _type);
 }
 
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "rb_entities.hpp"
 #include "rb_mesh.hpp"
 #include "rb_math.hpp"
 
@@ -16,78 +17,149 @@
 #define GAME_OBJECT_TYPE_CUBE       1
 #define GAME_OBJECT_TYPE_RECTANGLE  2
 #define GAME_OBJECT_TYPE_MESH       3
+#define GAME_OBJECT_TYPE_CHUNK      4
 
+class StaticChunk;
+
+// MARK: - Projection cache
+
+// Screen corners of a box fully inside the view, see GameEngine::ProjectBox()
+struct BoxProjection {
+    Vec3D screen[8];
+    int faces;              // Bit per visible face
+    int bright[6];
+};
+
+// Projection of the last frame, reused by GameEngine::DrawGameObject() while model and view are unchanged
+struct ProjectionCache {
+    std::vector<Triangle> tris;
+    std::vector<Vec3D> lines;           // Edge mode, pairs of screen points
+    BoxProjection box;
+    int visibility;
+    bool isBox;
+    bool isLines;
+    bool valid = false;
+    unsigned int modelVersion;
+    unsigned int viewVersion;
+    unsigned int staticViewVersion;
+};
+
+// Handle of an entity in the entity store, the state lives in its arrays, see EntityStore
 class GameObject {
+    friend class BroadPhase;
+    friend class EntityStore;
+
 public:
     GameObject(int type, int tag = 0);
     GameObject(std::string name, int tag = 0);
     GameObject(Mesh* mesh, int tag = 0);
+    GameObject(StaticChunk* chunk, int tag = 0);
+    ~GameObject();
+
+    GameObject(const GameObject&) = delete;
+    GameObject& operator=(const GameObject&) = delete;
+
+    void Reset(Mesh* mesh, int type, int tag);
+    static Mesh* GetPrimitive(int type);
 
 private:
     void Initialise();
+    bool ChangeModel(Vec3D& value, Vec3D newValue) {
+        if (value.x != newValue.x || value.y != newValue.y || value.z != newValue.z) {
+            value = newValue;
+            s_entities->modelVersion[_entity]++;
+            return true;
+        }
+
+        return false;
+    }
+    void UpdateBounds();
+    bool HasFlag(unsigned char flag) { return (s_entities->flags[_entity] & flag) != 0; }
+    void SetFlag(unsigned char flag, bool on) { if (on) s_entities->flags[_entity] |= flag; else s_entities->flags[_entity] &= ~flag; }
     
 public:
-    void SetPosition(float x, float y, float z) { _position = Vec3DMake(x, y, z); }
-    void SetPosition(Vec3D pos) { _position = pos; }
-    Vec3D& GetPosition() { return _position; }
-    void SetRotation(float x, float y, float z) { _rotation = Vec3DMake(x, y, z); }
-    Vec3D& GetRotation() { return _rotation; }
-    void SetScale(float x, float y, float z) { _scale = Vec3DMake(x, y, z); }
-    Vec3D& GetScale() { return _scale; }
-    void SetColor(int color) { _color = color; }
-    int GetColor() { return _color; }
-    void SetSpeed(float x, float y, float z) { _speed = Vec3DMake(x, y, z); }
-    Vec3D& GetSpeed() { return _speed; }
-    void SetRotationSpeed(float x, float y, float z) { _rotationSpeed = Vec3DMake(x, y, z); }
-    Vec3D& GetRotationSpeed() { return _rotationSpeed; }
+    void SetPosition(float x, float y, float z) { ChangeModel(s_entities->position[_entity], Vec3DMake(x, y, z)); }
+    void SetPosition(Vec3D pos) { ChangeModel(s_entities->position[_entity], pos); }
+    Vec3D& GetPosition() { return s_entities->position[_entity]; }
+    void SetRotation(float x, float y, float z) { if (ChangeModel(s_entities->rotation[_entity], Vec3DMake(x, y, z))) SetFlag(ENTITY_BOUNDS_CHANGED, true); }
+    Vec3D& GetRotation() { return s_entities->rotation[_entity]; }
+    void SetScale(float x, float y, float z) { if (ChangeModel(s_entities->scale[_entity], Vec3DMake(x, y, z))) SetFlag(ENTITY_BOUNDS_CHANGED, true); }
+    Vec3D& GetScale() { return s_entities->scale[_entity]; }
+    void SetColor(int color) { if (s_entities->color[_entity] != color) { s_entities->color[_entity] = color; s_entities->modelVersion[_entity]++; } }
+    int GetColor() { return s_entities->color[_entity]; }
+    void SetSpeed(float x, float y, float z) { s_entities->speed[_entity] = Vec3DMake(x, y, z); }
+    Vec3D& GetSpeed() { return s_entities->speed[_entity]; }
+    void SetRotationSpeed(float x, float y, float z) { s_entities->rotationSpeed[_entity] = Vec3DMake(x, y, z); }
+    Vec3D& GetRotationSpeed() { return s_entities->rotationSpeed[_entity]; }
     Mesh* GetMesh() { return _mesh; }
+    void SetMeshChanged() { s_entities->modelVersion[_entity]++; SetFlag(ENTITY_BOUNDS_CHANGED, true); }
+    unsigned int GetModelVersion() { return s_entities->modelVersion[_entity]; }
+    ProjectionCache& GetProjectionCache() { return _cache; }
+    StaticChunk* GetChunk() { return _chunk; }
     
+    void SetStatic(bool flag) { SetFlag(ENTITY_STATIC, flag); }
+    bool IsStatic() { return HasFlag(ENTITY_STATIC); }
+    Vec3D GetWorldPosition() { return IsStatic() ? Vec3DAdd(GetPosition(), s_scroll) : GetPosition(); }
+    static void SetScroll(Vec3D& scroll) { s_scroll = scroll; }
+
+    // Set by the engine while the object is in its game objects, moves the entity, see EntityStore::Attach()
+    void SetAdded(bool flag) { if (flag) s_entities->Attach(_entity); else s_entities->Detach(_entity); }
+    bool IsAdded() { return s_entities->IsLive(_entity); }
+    static void SetEntities(EntityStore* entities) { s_entities = entities; }
+
+    void SetPooled(bool flag) { _isPooled = flag; }
+    bool IsPooled() { return _isPooled; }
+
     void SetPlayer(bool flag) { _isPlayer = flag; }
-    void SetHidden(bool flag) { _isHidden = flag; }
-    void ToggleHidden() { _isHidden = !_isHidden; }
-    bool IsHidden() { return _isHidden; }
-    void SetDead() { _isDead = true; }
-    void SetAlive() { _isDead = false; }
-    bool IsDead() { return _isDead; }
-    void SetLifeTime(float sec) { _lifetime = sec; }
+    void SetHidden(bool flag) { SetFlag(ENTITY_HIDDEN, flag); }
+    void ToggleHidden() { SetFlag(ENTITY_HIDDEN, !IsHidden()); }
+    bool IsHidden() { return HasFlag(ENTITY_HIDDEN); }
+    void SetDead() { SetFlag(ENTITY_DEAD, true); }
+    void SetAlive() { SetFlag(ENTITY_DEAD, false); }
+    bool IsDead() { return HasFlag(ENTITY_DEAD); }
+    void SetLifeTimer(int timer) { s_entities->timer[_entity] = timer; }
+    int GetLifeTimer() { return s_entities->timer[_entity]; }
 
     int GetID() { return _id; }
-    int GetTag() { return _tag; }
+    int GetTag() { return s_entities->tag[_entity]; }
+    void SetTag(int tag) { s_entities->tag[_entity] = tag; }
 
-    void Move(float x, float y, float z) { _position.x += x;  _position.y += y; _position.z += z; }
-    void Update(float delta);
+    void Move(float x, float y, float z) { Vec3D& p = GetPosition(); p.x += x; p.y += y; p.z += z; s_entities->modelVersion[_entity]++; }
+    void Update(float delta) { s_entities->Update(_entity, delta); }
 
     void Dump();
     void Dump(int id);
 
-    float GetMinX() { return _position.x; }
-    float GetMinY() { return _position.y; }
-    float GetMinZ() { return _position.z; }
-    float GetMaxX() { return _position.x + _scale.x; }
-    float GetMaxY() { return _position.y + _scale.y; }
-    float GetMaxZ() { return _position.z + _scale.z; }
+    // Bounds in world space, the box of the mesh after scale and rotation. Static objects are moved by the scroll offset
+    float GetMinX() { return GetWorldPosition().x + GetLocalMin().x; }
+    float GetMinY() { return GetWorldPosition().y + GetLocalMin().y; }
+    float GetMinZ() { return GetWorldPosition().z + GetLocalMin().z; }
+    float GetMaxX() { return GetWorldPosition().x + GetLocalMax().x; }
+    float GetMaxY() { return GetWorldPosition().y + GetLocalMax().y; }
+    float GetMaxZ() { return GetWorldPosition().z + GetLocalMax().z; }
+    void GetBounds(Vec3D& min, Vec3D& max);
+
+    // Bounds relative to the position, updated when scale, rotation or mesh change
+    Vec3D& GetLocalMin() { if (HasFlag(ENTITY_BOUNDS_CHANGED)) UpdateBounds(); return s_entities->boundsMin[_entity]; }
+    Vec3D& GetLocalMax() { if (HasFlag(ENTITY_BOUNDS_CHANGED)) UpdateBounds(); return s_entities->boundsMax[_entity]; }
 
     bool IsColliding(GameObject& other);
 
 private:
-    const std::vector<Triangle> PrimtiveGetCube();
-    const std::vector<Triangle> PrimtiveGetRectangle();
+    static const std::vector<Triangle> PrimtiveGetCube();
+    static const std::vector<Triangle> PrimtiveGetRectangle();
 
 private:
     int _id;
-    int _tag;
+    int _entity;                // Index in the entity store, changes when entities are moved
     int _type;
-    int _color;
     Mesh* _mesh;
-    Vec3D _position;
-    Vec3D _rotation;
-    Vec3D _scale;
-    Vec3D _speed;
-    Vec3D _rotationSpeed;
-    float _lifetime;
-    float _elapsed;
-    bool _isHidden = false;
-    bool _isDead;
+    StaticChunk* _chunk = nullptr;
     bool _isPlayer = false;
+    bool _isPooled = false;     // Owned by GameObjectPool, returned when removed from the engine
+    ProjectionCache _cache;
     static Mesh* s_cube;
+    static Mesh* s_rectangle;
+    static Vec3D s_scroll;
+    static EntityStore* s_entities;     // Store of the engine, objects are created after it
 };
@@ -0,0 +1,116 @@
+//
+//  rb_occlusion.cpp
+//  3d wireframe game engine: occlusion culling
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_occlusion.hpp"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+void OcclusionBuffer::Clear(int width, int height) {
+    _cellWidth = (float)width / OCCLUSION_SIZE;
+    _cellHeight = (float)height / OCCLUSION_SIZE;
+    _quads = 0;
+
+    std::fill(&_depth[0][0], &_depth[0][0] + OCCLUSION_SIZE * OCCLUSION_SIZE, FLT_MAX);
+}
+
+// Convex quad in screen coordinates (render pixels), depth is the farthest z of its corners
+void OcclusionBuffer::AddQuad(Vec3D* screen, float depth) {
+    float minX = screen[0].x, maxX = screen[0].x;
+    float minY = screen[0].y, maxY = screen[0].y;
+    float area = 0.0f;
+
+    for (int i = 0; i < 4; i++) {
+        Vec3D& a = screen[i];
+        Vec3D& b = screen[(i + 1) & 3];
+
+        minX = std::min(minX, a.x); maxX = std::max(maxX, a.x);
+        minY = std::min(minY, a.y); maxY = std::max(maxY, a.y);
+        area += a.x * b.y - b.x * a.y;
+    }
+
+    // Faces seen edge on cover nothing
+    if (fabsf(area) < _cellWidth * _cellHeight) {
+        return;
+    }
+
+    float side = area > 0.0f ? 1.0f : -1.0f;
+    int y0 = std::max(0, (int)floorf(minY / _cellHeight));
+    int y1 = std::min(OCCLUSION_SIZE - 1, (int)floorf(maxY / _cellHeight));
+
+    // Inside span of the row of cell corners above the first row
+    float spanMin, spanMax;
+    GetSpan(screen, side, y0 * _cellHeight, spanMin, spanMax);
+
+    for (int y = y0; y <= y1; y++) {
+        // A cell is covered if its corners on both rows are inside the quad
+        float nextMin, nextMax;
+        GetSpan(screen, side, (y + 1) * _cellHeight, nextMin, nextMax);
+
+        float left = std::max(std::max(spanMin, nextMin) / _cellWidth, 0.0f);
+        float right = std::min(std::min(spanMax, nextMax) / _cellWidth, (float)OCCLUSION_SIZE);
+        int x0 = (int)ceilf(left);
+        int x1 = (int)floorf(right) - 1;
+
+        for (int x = x0; x <= x1; x++) {
+            _depth[y][x] = std::min(_depth[y][x], depth);
+        }
+
+        spanMin = nextMin;
+        spanMax = nextMax;
+    }
+
+    _quads++;
+}
+
+// Part of the horizontal line at y which is inside of all four edges
+void OcclusionBuffer::GetSpan(Vec3D* screen, float side, float y, float& spanMin, float& spanMax) {
+    spanMin = -FLT_MAX;
+    spanMax = FLT_MAX;
+
+    for (int i = 0; i < 4; i++) {
+        Vec3D& a = screen[i];
+        Vec3D& b = screen[(i + 1) & 3];
+
+        // Inside if (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x) has the sign of the area
+        float slope = (b.y - a.y) * side;
+        float offset = ((b.x - a.x) * (y - a.y) + (b.y - a.y) * a.x) * side;
+
+        if (slope > 0.0f) spanMax = std::min(spanMax, offset / slope);
+        else if (slope < 0.0f) spanMin = std::max(spanMin, offset / slope);
+        else if (offset < 0.0f) spanMax = -FLT_MAX;
+    }
+}
+
+// Screen rectangle (render pixels) and nearest z of an object, hidden if every cell it
+// touches on the screen has a nearer occluder
+bool OcclusionBuffer::IsOccluded(float minX, float minY, float maxX, float maxY, float depth) {
+    if (_quads == 0) {
+        return false;
+    }
+
+    int x0 = std::max(0, (int)floorf(minX / _cellWidth));
+    int x1 = std::min(OCCLUSION_SIZE - 1, (int)floorf(maxX / _cellWidth));
+    int y0 = std::max(0, (int)floorf(minY / _cellHeight));
+    int y1 = std::min(OCCLUSION_SIZE - 1, (int)floorf(maxY / _cellHeight));
+
+    if (x0 > x1 || y0 > y1) {
+        return false;
+    }
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            if (_depth[y][x] >= depth) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,37 @@
+//
+//  rb_occlusion.hpp
+//  3d wireframe game engine: occlusion culling
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_types.hpp"
+
+// Resolution of the occluder depth buffer in both directions
+#define OCCLUSION_SIZE      64
+
+// Coarse depth buffer over the screen, filled with the faces of large static boxes.
+// A cell only gets the depth of a face which covers it completely, that way a
+// test against the buffer never hides an object which is visible
+class OcclusionBuffer {
+public:
+    OcclusionBuffer() {}
+
+    void Clear(int width, int height);
+    void AddQuad(Vec3D* screen, float depth);
+    bool IsOccluded(float minX, float minY, float maxX, float maxY, float depth);
+
+    int GetOccluderCount() { return _quads; }
+
+private:
+    void GetSpan(Vec3D* screen, float side, float y, float& spanMin, float& spanMax);
+
+private:
+    float _depth[OCCLUSION_SIZE][OCCLUSION_SIZE];   // View space z of the nearest occluder
+    float _cellWidth = 1.0f;
+    float _cellHeight = 1.0f;
+    int _quads = 0;
+};
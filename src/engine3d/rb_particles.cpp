@@ -0,0 +1,119 @@
+//
+//  rb_particles.cpp
+//  3d wireframe game engine: particles
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_particles.hpp"
+
+#include <stdlib.h>
+
+static float Random() {
+    return (float)rand() / (float)RAND_MAX;
+}
+
+// Particles fly in random directions from pos, returns the number of particles added
+int ParticleSystem::Emit(Vec3D& pos, Vec3D& velocity, int count, float speed, float lifetime, byte color) {
+    int added = 0;
+
+    while (added < count && _count < PARTICLE_CAPACITY) {
+        // Random direction inside of the unit sphere
+        float dx = Random() * 2.0f - 1.0f;
+        float dy = Random() * 2.0f - 1.0f;
+        float dz = Random() * 2.0f - 1.0f;
+
+        if (dx * dx + dy * dy + dz * dz > 1.0f) {
+            continue;
+        }
+
+        int i = _count++;
+        _x[i] = pos.x;
+        _y[i] = pos.y;
+        _z[i] = pos.z;
+        _vx[i] = velocity.x + dx * speed;
+        _vy[i] = velocity.y + dy * speed;
+        _vz[i] = velocity.z + dz * speed;
+        _life[i] = lifetime * (0.5f + 0.5f * Random());
+        _color[i] = color;
+
+        added++;
+    }
+
+    return added;
+}
+
+void ParticleSystem::Update(float deltaTime) {
+    float gravity = PARTICLE_GRAVITY * deltaTime;
+    int count = _count;
+
+    // No branches and one array per component, the compiler vectorises this loop
+    for (int i = 0; i < count; i++) {
+        _vy[i] += gravity;
+        _x[i] += _vx[i] * deltaTime;
+        _y[i] += _vy[i] * deltaTime;
+        _z[i] += _vz[i] * deltaTime;
+        _life[i] -= deltaTime;
+    }
+
+    // Dead particles are replaced by the last one
+    for (int i = 0; i < _count; ) {
+        if (_life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+
+        int last = --_count;
+        _x[i] = _x[last]; _y[i] = _y[last]; _z[i] = _z[last];
+        _vx[i] = _vx[last]; _vy[i] = _vy[last]; _vz[i] = _vz[last];
+        _life[i] = _life[last];
+        _color[i] = _color[last];
+    }
+}
+
+// All particles into segments in render coordinates, same projection as GameEngine::ProjectViewed().
+// matView takes level space to view space, world matrix included. Returns the number of segments
+int ParticleSystem::Project(Mat4x4& matView, Mat4x4& matProj, float width, float height) {
+    if (_count == 0) {
+        return 0;
+    }
+
+    Mat4x4& m = matView;
+    float scaleX = matProj.m[0][0] * 0.5f * width;
+    float scaleY = matProj.m[1][1] * 0.5f * height;
+    float centerX = 0.5f * width;
+    float centerY = 0.5f * height;
+    int stride = (_count + PARTICLE_SEGMENTS_MAX - 1) / PARTICLE_SEGMENTS_MAX;
+    int segments = 0;
+
+    for (int i = 0; i < _count; i += stride) {
+        // Head in view space, the tail is where the particle was PARTICLE_TRAIL seconds ago
+        float hx = _x[i] * m.m[0][0] + _y[i] * m.m[1][0] + _z[i] * m.m[2][0] + m.m[3][0];
+        float hy = _x[i] * m.m[0][1] + _y[i] * m.m[1][1] + _z[i] * m.m[2][1] + m.m[3][1];
+        float hz = _x[i] * m.m[0][2] + _y[i] * m.m[1][2] + _z[i] * m.m[2][2] + m.m[3][2];
+        float tx = hx - (_vx[i] * m.m[0][0] + _vy[i] * m.m[1][0] + _vz[i] * m.m[2][0]) * PARTICLE_TRAIL;
+        float ty = hy - (_vx[i] * m.m[0][1] + _vy[i] * m.m[1][1] + _vz[i] * m.m[2][1]) * PARTICLE_TRAIL;
+        float tz = hz - (_vx[i] * m.m[0][2] + _vy[i] * m.m[1][2] + _vz[i] * m.m[2][2]) * PARTICLE_TRAIL;
+
+        // Near plane
+        if (hz < 0.1f || tz < 0.1f) {
+            continue;
+        }
+
+        _sx1[segments] = centerX - scaleX * hx / hz;
+        _sy1[segments] = centerY - scaleY * hy / hz;
+        _sx2[segments] = centerX - scaleX * tx / tz;
+        _sy2[segments] = centerY - scaleY * ty / tz;
+        _scolor[segments] = _color[i];
+        segments++;
+    }
+
+    return segments;
+}
+
+void ParticleSystem::GetSegment(int n, Vec3D& p1, Vec3D& p2, byte& color) {
+    p1 = Vec3DMakef(_sx1[n], _sy1[n], 0.0f);
+    p2 = Vec3DMakef(_sx2[n], _sy2[n], 0.0f);
+    color = _scolor[n];
+}
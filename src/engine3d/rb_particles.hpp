@@ -0,0 +1,61 @@
+//
+//  rb_particles.hpp
+//  3d wireframe game engine: particles
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_math.hpp"
+#include "rb_types.hpp"
+
+// Particles alive at the same time, emitting more drops the rest, this caps the cost of one frame
+#define PARTICLE_CAPACITY       128
+
+// Segments drawn per frame, with more particles alive only every n-th one is drawn
+#define PARTICLE_SEGMENTS_MAX   64
+
+// Debris of a destroyed object, see GameEngine::AddExplosion()
+#define PARTICLE_EXPLOSION_COUNT    24
+#define PARTICLE_EXPLOSION_SPEED    4.0f
+#define PARTICLE_EXPLOSION_LIFETIME 1.2f
+
+#define PARTICLE_GRAVITY        6.0f    // Along +y, which points down on the screen
+#define PARTICLE_TRAIL          0.06f   // Seconds of movement drawn as one segment
+
+// Short lived points with a velocity, stored as one array per component and drawn as
+// short segments along their movement
+class ParticleSystem {
+public:
+    ParticleSystem() {}
+
+    int Emit(Vec3D& pos, Vec3D& velocity, int count, float speed, float lifetime, byte color);
+    void Update(float deltaTime);
+    void Clear() { _count = 0; }
+
+    int Project(Mat4x4& matView, Mat4x4& matProj, float width, float height);
+    void GetSegment(int n, Vec3D& p1, Vec3D& p2, byte& color);
+
+    int GetCount() { return _count; }
+
+private:
+    // Particles, only the first _count entries are alive
+    float _x[PARTICLE_CAPACITY];
+    float _y[PARTICLE_CAPACITY];
+    float _z[PARTICLE_CAPACITY];
+    float _vx[PARTICLE_CAPACITY];
+    float _vy[PARTICLE_CAPACITY];
+    float _vz[PARTICLE_CAPACITY];
+    float _life[PARTICLE_CAPACITY];     // Seconds left
+    byte _color[PARTICLE_CAPACITY];
+    int _count = 0;
+
+    // Segments of the last Project() in render coordinates
+    float _sx1[PARTICLE_SEGMENTS_MAX];
+    float _sy1[PARTICLE_SEGMENTS_MAX];
+    float _sx2[PARTICLE_SEGMENTS_MAX];
+    float _sy2[PARTICLE_SEGMENTS_MAX];
+    byte _scolor[PARTICLE_SEGMENTS_MAX];
+};
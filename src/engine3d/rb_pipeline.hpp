@@ -0,0 +1,244 @@
+//
+//  rb_pipeline.hpp
+//  3d wireframe game engine: render pipeline variants
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_engine.hpp"
+#include "rb_math.hpp"
+#include "rb_platform.h"
+
+#include <vector>
+#include <list>
+#include <algorithm>
+
+// The pipeline stages are templates on the policies below, every combination the
+// engine uses is instantiated once, so the inner loops contain no mode checks
+
+// MARK: - Vertex storage
+
+// Float vertices, triangles may have own colors and hidden lines
+struct VerticesFloat {
+    static Vec3D Get(Mesh& mesh, size_t tri, int i) { return mesh.tris[tri].p[i]; }
+    static byte Color(Mesh& mesh, size_t tri) { return mesh.triangleColors ? mesh.tris[tri].color : mesh.color; }
+    static int Hide(Mesh& mesh, size_t tri) { return mesh.tris[tri].h; }
+};
+
+// 16 bit vertices, dequantised when fetched, see Mesh::Quantise()
+struct VerticesQuantised {
+    static Vec3D Get(Mesh& mesh, size_t tri, int i) { return mesh.Dequantise(mesh.quantisedTris[tri].p[i]); }
+    static byte Color(Mesh& mesh, size_t) { return mesh.color; }
+    static int Hide(Mesh&, size_t) { return 0; }
+};
+
+// MARK: - Fill mode
+
+// Filled triangles are clipped as one polygon and drawn as a fan, the inner
+// edges of a fan would be visible in wireframe
+
+struct FillWireframe {
+    static const bool polygons = false;
+
+    static void Draw(GameEngine& engine, Triangle& t) {
+        engine.DrawTriangle(t.p[0], t.p[1], t.p[2], t.color, t.h);
+    }
+};
+
+struct FillSolid {
+    static const bool polygons = true;
+
+    static void Draw(GameEngine& engine, Triangle& t) {
+        engine.FillTriangle(t.p[0].x, t.p[0].y, t.p[1].x, t.p[1].y, t.p[2].x, t.p[2].y, t.color, t.bright);
+    }
+};
+
+// MARK: - Lighting
+
+// Brightness of the visible faces, only used by filled triangles
+struct LightingOn {
+    static const bool enabled = true;
+};
+
+struct LightingOff {
+    static const bool enabled = false;
+};
+
+// MARK: - Sorting
+
+// Back to front order of the triangles of one object, only needed by filled triangles
+struct SortOn {
+    static void Apply(std::vector<Triangle>& tris) {
+        std::sort(tris.begin(), tris.end(), [](const Triangle &t1, const Triangle &t2) {
+            float z1 = (t1.p[0].z + t1.p[1].z + t1.p[2].z) / 3.0f;
+            float z2 = (t2.p[0].z + t2.p[1].z + t2.p[2].z) / 3.0f;
+            return z1 > z2;
+        });
+    }
+};
+
+struct SortOff {
+    static void Apply(std::vector<Triangle>&) {}
+};
+
+// MARK: - Output backend
+
+// Rasterises into the platform frame buffer
+struct OutputScreen {
+    template <class Fill> static void Emit(GameEngine& engine, Triangle& t) { Fill::Draw(engine, t); }
+};
+
+// Drops all triangles, measures the pipeline without the rasteriser
+struct OutputNone {
+    template <class Fill> static void Emit(GameEngine&, Triangle&) {}
+};
+
+// MARK: - Clip strategy
+
+// Objects fully inside the frustum (see GameEngine::ClassifyMesh), triangles reaching
+// into the guard band are scissored by the rasteriser
+struct ClipNone {
+    static const bool nearPlane = false;
+
+    template <class Fill, class Output> static int Raster(GameEngine& engine, std::vector<Triangle>& tris) {
+        for (auto &t : tris) {
+            Output::template Emit<Fill>(engine, t);
+        }
+
+        return (int)tris.size();
+    }
+};
+
+// Objects crossing the frustum, triangles are clipped against the near plane and the screen edges
+struct ClipFrustum {
+    static const bool nearPlane = true;
+
+    template <class Fill, class Output> static int Raster(GameEngine& engine, std::vector<Triangle>& tris) {
+        float maxX = (float)engine.GetClipMaxX();
+        float maxY = (float)engine.GetClipMaxY();
+        int count = 0;
+
+        // Loop through all transformed, viewed, projected, and sorted triangles
+        for (auto &triToRaster : tris) {
+            Vec3D* p = triToRaster.p;
+
+            // Trivial reject if all points are outside of the same edge
+            int code0 = Vec3DOutcode(p[0], 0.0f, 0.0f, maxX, maxY);
+            int code1 = Vec3DOutcode(p[1], 0.0f, 0.0f, maxX, maxY);
+            int code2 = Vec3DOutcode(p[2], 0.0f, 0.0f, maxX, maxY);
+
+            if (code0 & code1 & code2) {
+                continue;
+            }
+
+            // Trivial accept if inside the guard band, the rasteriser scissors the rest
+            bool accept = (code0 | code1 | code2) == OUTCODE_INSIDE;
+            if (!accept) {
+                accept = (Vec3DOutcode(p[0], -CLIP_GUARD_BAND, -CLIP_GUARD_BAND, maxX + CLIP_GUARD_BAND, maxY + CLIP_GUARD_BAND) |
+                          Vec3DOutcode(p[1], -CLIP_GUARD_BAND, -CLIP_GUARD_BAND, maxX + CLIP_GUARD_BAND, maxY + CLIP_GUARD_BAND) |
+                          Vec3DOutcode(p[2], -CLIP_GUARD_BAND, -CLIP_GUARD_BAND, maxX + CLIP_GUARD_BAND, maxY + CLIP_GUARD_BAND)) == OUTCODE_INSIDE;
+            }
+
+            if (accept) {
+                Output::template Emit<Fill>(engine, triToRaster);
+                count++;
+                continue;
+            }
+
+            if (Fill::polygons) count += ClipPolygon<Fill, Output>(engine, triToRaster, code0 | code1 | code2, maxX, maxY);
+            else count += ClipTriangle<Fill, Output>(engine, triToRaster, maxX, maxY);
+        }
+
+        return count;
+    }
+
+    // Sutherland-Hodgman against the edges the triangle crosses, drawn as a fan
+    template <class Fill, class Output> static int ClipPolygon(GameEngine& engine, Triangle& tri, int codes, float maxX, float maxY) {
+        Vec3D polygon[POLYGON_CLIP_MAX_VERTICES] = { tri.p[0], tri.p[1], tri.p[2] };
+        int n = PolygonClipAgainstRect(polygon, 3, codes, 0.0f, 0.0f, maxX, maxY);
+
+        Triangle fan = tri;
+        fan.p[0] = polygon[0];
+
+        for (int i = 1; i + 1 < n; i++) {
+            fan.p[1] = polygon[i];
+            fan.p[2] = polygon[i + 1];
+            Output::template Emit<Fill>(engine, fan);
+        }
+
+        return std::max(n - 2, 0);
+    }
+
+    template <class Fill, class Output> static int ClipTriangle(GameEngine& engine, Triangle& tri, float maxX, float maxY) {
+        // Clip triangles against all four screen edges, this could yield
+        // a bunch of triangles, so create a queue that we traverse to
+        // ensure we only test new triangles generated against planes
+        Triangle clipped[2];
+        std::list<Triangle> listTriangles;
+
+        // Add initial triangle
+        listTriangles.push_back(tri);
+        int nNewTriangles = 1;
+
+        for (int p = 0; p < 4; p++) {
+            int nTrisToAdd = 0;
+
+            while (nNewTriangles > 0) {
+                // Take triangle from front of queue
+                Triangle test = listTriangles.front();
+                listTriangles.pop_front();
+                nNewTriangles--;
+
+                // Clip it against a plane. We only need to test each
+                // subsequent plane, against subsequent new triangles
+                // as all triangles after a plane clip are guaranteed
+                // to lie on the inside of the plane
+                switch (p) {
+                    case 0: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakeZero(), Vec3DMakef(0.0f, 1.0f, 0.0f), test, clipped[0], clipped[1]); break;
+                    case 1: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakef(0.0f, maxY, 0.0f), Vec3DMakef(0.0f, -1.0f, 0.0f) , test, clipped[0], clipped[1]); break;
+                    case 2: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakeZero(), Vec3DMakef(1.0f, 0.0f, 0.0f), test, clipped[0], clipped[1]); break;
+                    case 3: nTrisToAdd = TriangleClipAgainstPlane(Vec3DMakef(maxX, 0.0f, 0.0f), Vec3DMakef(-1.0f, 0.0f, 0.0f), test, clipped[0], clipped[1]); break;
+                }
+
+                // Clipping may yield a variable number of triangles, so
+                // add these new ones to the back of the queue for subsequent
+                // clipping against next planes
+                for (int w = 0; w < nTrisToAdd; w++) {
+                    listTriangles.push_back(clipped[w]);
+                }
+            }
+
+            nNewTriangles = (int)listTriangles.size();
+        }
+
+        for (auto &t : listTriangles) {
+            Output::template Emit<Fill>(engine, t);
+        }
+
+        return (int)listTriangles.size();
+    }
+};
+
+// MARK: - Pipeline
+
+template <class FillMode, class LightingMode, class SortMode, class ClipMode, class OutputMode>
+struct RenderPipeline {
+    typedef FillMode Fill;
+    typedef LightingMode Lighting;
+    typedef SortMode Sort;
+    typedef ClipMode Clip;
+    typedef OutputMode Output;
+};
+
+// Both stages of one pipeline, each stage is only instantiated for the policies it depends on
+template <class Pipeline> RenderVariant MakeRenderVariant(const char* name) {
+    RenderVariant variant;
+    variant.name = name;
+    variant.transform = &GameEngine::TransformWith<typename Pipeline::Lighting, typename Pipeline::Sort, typename Pipeline::Clip>;
+    variant.raster = &GameEngine::RasterWith<typename Pipeline::Fill, typename Pipeline::Clip, typename Pipeline::Output>;
+
+    return variant;
+}
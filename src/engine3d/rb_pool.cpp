@@ -0,0 +1,50 @@
+//
+//  rb_pool.cpp
+//  3d wireframe game engine: game object pool
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_pool.hpp"
+
+GameObjectPool::~GameObjectPool() {
+    for (auto object : _objects) {
+        delete object;
+    }
+}
+
+GameObject* GameObjectPool::New(Mesh* mesh, int type, int tag) {
+    GameObject* object;
+
+    if (!_free.empty()) {
+        object = _free.back();
+        _free.pop_back();
+        object->Reset(mesh, type, tag);
+        _stats.reused++;
+    }
+    else {
+        object = new GameObject(mesh, tag);
+        object->Reset(mesh, type, tag);
+        object->SetPooled(true);
+        _objects.push_back(object);
+        _stats.allocated++;
+    }
+
+    _stats.live++;
+    if (_stats.live > _stats.peak) {
+        _stats.peak = _stats.live;
+    }
+
+    return object;
+}
+
+// Objects not created by the pool are left alone
+void GameObjectPool::Release(GameObject* object) {
+    if (object == nullptr || !object->IsPooled()) {
+        return;
+    }
+
+    _free.push_back(object);
+    _stats.live--;
+}
@@ -0,0 +1,39 @@
+//
+//  rb_pool.hpp
+//  3d wireframe game engine: game object pool
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_object.hpp"
+
+#include <vector>
+
+// Objects handed out by the pool, see GameEngine::GetPoolStats()
+struct PoolStats {
+    long live = 0;              // In use right now
+    long peak = 0;              // Most objects in use at the same time
+    long allocated = 0;         // Objects created, stays at the peak once the game runs
+    long reused = 0;            // Objects taken from the free list
+};
+
+// Game objects spawned and removed all the time. Removed objects go to a free list and are
+// reset for the next spawn, so the number of objects never grows above the peak in use
+class GameObjectPool {
+public:
+    GameObjectPool() {}
+    ~GameObjectPool();
+
+    GameObject* New(Mesh* mesh, int type, int tag);
+    void Release(GameObject* object);
+
+    PoolStats& GetStats() { return _stats; }
+
+private:
+    std::vector<GameObject*> _objects;      // All objects created by the pool
+    std::vector<GameObject*> _free;
+    PoolStats _stats;
+};
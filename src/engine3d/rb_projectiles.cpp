@@ -0,0 +1,51 @@
+//
+//  rb_projectiles.cpp
+//  3d wireframe game engine: projectiles
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_projectiles.hpp"
+
+// Returns the index of the new projectile or -1 if all are in flight
+int ProjectileSystem::Fire(Vec3D& pos, Vec3D& velocity, float lifetime, byte color, int tag) {
+    if (_count >= PROJECTILE_CAPACITY) {
+        return -1;
+    }
+
+    Projectile& p = _projectiles[_count];
+    p.pos = pos;
+    p.last = pos;
+    p.velocity = velocity;
+    p.life = lifetime;
+    p.color = color;
+    p.tag = tag;
+
+    return _count++;
+}
+
+void ProjectileSystem::Update(float deltaTime) {
+    for (int i = 0; i < _count; ) {
+        Projectile& p = _projectiles[i];
+
+        p.life -= deltaTime;
+
+        // The last projectile takes the place of the expired one
+        if (p.life <= 0.0f) {
+            p = _projectiles[--_count];
+            continue;
+        }
+
+        p.last = p.pos;
+        p.pos.x += p.velocity.x * deltaTime;
+        p.pos.y += p.velocity.y * deltaTime;
+        p.pos.z += p.velocity.z * deltaTime;
+        i++;
+    }
+}
+
+// Dropped by the next update, until then the indices of all other projectiles stay valid
+void ProjectileSystem::Remove(int n) {
+    _projectiles[n].life = 0.0f;
+}
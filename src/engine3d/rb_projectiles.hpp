@@ -0,0 +1,48 @@
+//
+//  rb_projectiles.hpp
+//  3d wireframe game engine: projectiles
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include "rb_math.hpp"
+#include "rb_types.hpp"
+
+// Projectiles in flight at the same time, firing more is ignored
+#define PROJECTILE_CAPACITY     64
+
+#define PROJECTILE_SIZE         1.0f    // Edge of the hit box around the projectile, larger than the bullet to ease aiming
+#define PROJECTILE_LENGTH       0.5f    // Length of the vector drawn (world units)
+
+// Projectile in level space, its hit box is centered on pos
+struct Projectile {
+    Vec3D pos;
+    Vec3D last;             // Position before the last update, start of the swept hit test
+    Vec3D velocity;
+    float life;             // Seconds left, removed projectiles stay until the next update with 0
+    byte color;
+    int tag;                // Collision tag, see BroadPhase
+};
+
+// Bullets without a game object, drawn as single vectors and hit tested by the broad phase
+// along the way they moved in the last frame, so fast projectiles can't pass through thin objects
+class ProjectileSystem {
+public:
+    ProjectileSystem() {}
+
+    int Fire(Vec3D& pos, Vec3D& velocity, float lifetime, byte color, int tag);
+    void Update(float deltaTime);
+    void Remove(int n);
+    void Clear() { _count = 0; }
+
+    Projectile& Get(int n) { return _projectiles[n]; }
+    bool IsAlive(int n) { return _projectiles[n].life > 0.0f; }
+    int GetCount() { return _count; }
+
+private:
+    Projectile _projectiles[PROJECTILE_CAPACITY];
+    int _count = 0;
+};
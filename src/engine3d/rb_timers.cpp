@@ -0,0 +1,218 @@
+//
+//  rb_timers.cpp
+//  3d wireframe game engine: timer wheel
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#include "rb_timers.hpp"
+
+#define TIMER_SLOT_MASK     (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_RANGE         (1u << (TIMER_WHEEL_BITS * TIMER_WHEELS))
+
+// Handles hold the index and the generation, so a handle of a reused timer doesn't match
+#define TIMER_HANDLE(n, generation)     (((int)((generation) & 0x7fff) << 16) | (n))
+#define TIMER_INDEX(timer)              ((timer) & 0xffff)
+#define TIMER_GENERATION(timer)         ((unsigned short)((timer) >> 16))
+
+TimerWheel::TimerWheel() {
+    for (int wheel = 0; wheel < TIMER_WHEELS; wheel++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            _slots[wheel][slot] = TIMER_NONE;
+        }
+    }
+}
+
+// MARK: - Timers
+
+// Calls back once after the given time, returns the handle used to cancel it
+int TimerWheel::Add(float seconds, std::function<void()> callback) {
+    return Schedule((unsigned int)(seconds / TIMER_TICK + 0.5f), 0, callback);
+}
+
+// Calls back every interval until cancelled
+int TimerWheel::AddRepeating(float interval, std::function<void()> callback) {
+    unsigned int ticks = (unsigned int)(interval / TIMER_TICK + 0.5f);
+    if (ticks < 1) {
+        ticks = 1;
+    }
+
+    return Schedule(ticks, ticks, callback);
+}
+
+bool TimerWheel::Cancel(int timer) {
+    Timer* t = Get(timer);
+    if (t == nullptr) {
+        return false;
+    }
+
+    // Freed when its slot comes up
+    t->active = false;
+    t->callback = nullptr;
+    _count--;
+
+    return true;
+}
+
+bool TimerWheel::IsActive(int timer) {
+    return Get(timer) != nullptr;
+}
+
+void TimerWheel::Clear() {
+    for (int n = 0; n < (int)_timers.size(); n++) {
+        if (_timers[n].active) {
+            _timers[n].active = false;
+            _timers[n].callback = nullptr;
+            _count--;
+        }
+    }
+}
+
+Timer* TimerWheel::Get(int timer) {
+    if (timer < 0 || TIMER_INDEX(timer) >= (int)_timers.size()) {
+        return nullptr;
+    }
+
+    Timer& t = _timers[TIMER_INDEX(timer)];
+    if (!t.active || (t.generation & 0x7fff) != TIMER_GENERATION(timer)) {
+        return nullptr;
+    }
+
+    return &t;
+}
+
+int TimerWheel::Schedule(unsigned int ticks, unsigned int interval, std::function<void()>& callback) {
+    int n = _free;
+
+    if (n != TIMER_NONE) {
+        _free = _timers[n].next;
+    }
+    else {
+        if (_timers.size() > 0xffff) {
+            return TIMER_NONE;
+        }
+
+        n = (int)_timers.size();
+        _timers.push_back(Timer());
+        _timers[n].generation = 0;
+    }
+
+    // Due at the earliest with the next tick, the slot of this one is already done
+    Timer& t = _timers[n];
+    t.expires = _now + (ticks < 1 ? 1 : ticks);
+    t.interval = interval;
+    t.callback = callback;
+    t.active = true;
+    _count++;
+
+    Insert(n);
+
+    return TIMER_HANDLE(n, t.generation);
+}
+
+void TimerWheel::Free(int n) {
+    Timer& t = _timers[n];
+    t.generation++;
+    t.active = false;
+    t.callback = nullptr;
+    t.next = _free;
+    _free = n;
+}
+
+// MARK: - Wheels
+
+// The finest wheel which reaches the expiry tick
+void TimerWheel::Insert(int n) {
+    Timer& t = _timers[n];
+    unsigned int delta = t.expires - _now;
+
+    if (delta >= TIMER_RANGE) {
+        t.expires = _now + TIMER_RANGE - 1;
+        delta = TIMER_RANGE - 1;
+    }
+
+    int wheel = 0;
+    while (wheel < TIMER_WHEELS - 1 && delta >= (1u << (TIMER_WHEEL_BITS * (wheel + 1)))) {
+        wheel++;
+    }
+
+    int slot = (t.expires >> (TIMER_WHEEL_BITS * wheel)) & TIMER_SLOT_MASK;
+    t.next = _slots[wheel][slot];
+    _slots[wheel][slot] = n;
+}
+
+// Timers of the current slot of a coarse wheel are due within its range, they move to the finer wheels
+void TimerWheel::Cascade(int wheel) {
+    int slot = (_now >> (TIMER_WHEEL_BITS * wheel)) & TIMER_SLOT_MASK;
+    int n = _slots[wheel][slot];
+    _slots[wheel][slot] = TIMER_NONE;
+
+    while (n != TIMER_NONE) {
+        int next = _timers[n].next;
+
+        if (_timers[n].active) {
+            Insert(n);
+        }
+        else {
+            Free(n);
+        }
+
+        n = next;
+    }
+}
+
+void TimerWheel::Tick() {
+    _now++;
+
+    for (int wheel = 1; wheel < TIMER_WHEELS; wheel++) {
+        if ((_now >> (TIMER_WHEEL_BITS * (wheel - 1))) & TIMER_SLOT_MASK) {
+            break;
+        }
+
+        Cascade(wheel);
+    }
+
+    // Callbacks may add or cancel timers, so the slot is emptied first
+    int slot = _now & TIMER_SLOT_MASK;
+    int n = _slots[0][slot];
+    _slots[0][slot] = TIMER_NONE;
+    _expired.clear();
+
+    while (n != TIMER_NONE) {
+        _expired.push_back(n);
+        n = _timers[n].next;
+    }
+
+    for (auto expired : _expired) {
+        Timer& t = _timers[expired];
+
+        if (!t.active) {
+            Free(expired);
+            continue;
+        }
+
+        std::function<void()> callback = t.callback;
+
+        if (t.interval > 0) {
+            t.expires = _now + t.interval;
+            Insert(expired);
+        }
+        else {
+            _count--;
+            Free(expired);
+        }
+
+        callback();
+    }
+}
+
+// Runs all ticks of the frame, the wheels move in steps of TIMER_TICK
+void TimerWheel::Advance(float seconds) {
+    _remainder += seconds;
+
+    while (_remainder >= TIMER_TICK) {
+        _remainder -= TIMER_TICK;
+        Tick();
+    }
+}
@@ -0,0 +1,62 @@
+//
+//  rb_timers.hpp
+//  3d wireframe game engine: timer wheel
+//
+//  04-08-2021, created by Roger Boesch
+//  Copyright © 2021 by Roger Boesch - use only with permission
+//
+
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#define TIMER_TICK          0.01f                   // Seconds per tick
+#define TIMER_WHEEL_BITS    6
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEELS        3                       // 2^18 ticks, longer timers are clamped to about 43 minutes
+#define TIMER_NONE          -1
+
+// Callback scheduled by TimerWheel::Add(), kept in the slot list of its expiry tick
+struct Timer {
+    unsigned int expires;               // Tick
+    unsigned int interval;              // Ticks between repeats, 0 fires once
+    std::function<void()> callback;
+    int next;                           // Next timer in the same slot or in the free list
+    unsigned short generation;          // Changed when the timer is reused, old handles are ignored
+    bool active;
+};
+
+// Hierarchical timer wheel, three wheels of 64 slots with 1, 64 and 4096 ticks per slot. Timers wait
+// in the coarse wheels and move down to the finer ones when their slot comes up, so each tick only
+// touches the timers of one slot. Cancelled timers stay in their slot until then
+class TimerWheel {
+public:
+    TimerWheel();
+
+    int Add(float seconds, std::function<void()> callback);
+    int AddRepeating(float interval, std::function<void()> callback);
+    bool Cancel(int timer);
+    bool IsActive(int timer);
+    void Clear();
+
+    void Advance(float seconds);
+    int GetCount() { return _count; }
+
+private:
+    int Schedule(unsigned int ticks, unsigned int interval, std::function<void()>& callback);
+    void Insert(int n);
+    void Cascade(int wheel);
+    void Tick();
+    void Free(int n);
+    Timer* Get(int timer);
+
+private:
+    std::vector<Timer> _timers;
+    int _slots[TIMER_WHEELS][TIMER_WHEEL_SLOTS];    // First timer of each slot
+    int _free = TIMER_NONE;
+    int _count = 0;                                 // Active timers
+    unsigned int _now = 0;                          // Ticks since start
+    float _remainder = 0;                           // Seconds not yet a full tick
+    std::vector<int> _expired;
+};
@@ -33,6 +33,7 @@
 #define HORIZONT             234    // Y position of horizont
 #define LEVEL_OFFSET         2      // Offset in level creation
 #define SECTION_TIME         2.0    // Time until next section gets created
+#define BENCHMARK_FRAMES     20     // Frames drawn by each variant of the pipeline benchmark
 
 #define CAMERA_INTRO        {0, 0, -9}
 #define CAMERA_YAW_INTRO     0
@@ -76,7 +77,11 @@
 #define STR_LEVEL_LOST (char*)"LEVEL LOST"
 #define STR_PLAYER_DESTROYED (char*)"PLAYER DESTROYED"
 
-#define GAME_OBJECT_PLAYER 100
+#define GAME_OBJECT_PLAYER 16    // Below COLLISION_TAGS, see SetCollisionMask()
+
+// Tags hit by the player bullets, the player also collides with enemy bullets and the level
+#define COLLISION_ENEMIES (COLLISION_BIT(LEVEL_OBJECT_JET_STANDING) | COLLISION_BIT(LEVEL_OBJECT_JET_FLYING) | COLLISION_BIT(LEVEL_OBJECT_TANK) | \
+                           COLLISION_BIT(LEVEL_OBJECT_ROCKET) | COLLISION_BIT(LEVEL_OBJECT_FUELSILO))
 
 typedef enum _GAME_STATE {
     GAME_INITIALIZE, GAME_INTRO, GAME_PLAY, GAME_END, GAME_LOST, PLAYER_HIT
@@ -100,7 +105,6 @@ private:
     GameObject* _tank;
     GameObject* _rocket;
     GameObject* _jet;
-    GameObject* _bullet;
     Mesh* _spaceshipMesh;
 
     int _levelNumber = 1;
@@ -115,10 +119,9 @@ private:
     float _score = 0;
     GAME_STATE _state = GAME_INITIALIZE;
 
-    float _borderDelay = 0;
     float _fYaw = 0;
 
-    std::vector<GameObject *> m_bullets;
+    GAME_STATE _statsState = GAME_INITIALIZE;
 
     // MARK: - Life cycle
 protected:
@@ -143,8 +146,10 @@ protected:
         _rocket = new GameObject("rocket", LEVEL_OBJECT_ROCKET);
         _rocket->SetColor(colorRed);
 
-        _bullet = new GameObject("bullet", LEVEL_OBJECT_BULLET);
-        _bullet->SetColor(colorYellow);
+        MeshMemory memory = Mesh::GetMemory();
+        RBLOG_NUM1("Models quantised", (int)memory.quantised);
+        RBLOG_NUM1(" Vertex storage (bytes)", (int)memory.bytes);
+        RBLOG_NUM1(" Saved (bytes)", (int)memory.bytesSaved);
 
         _player = new GameObject(_jet->GetMesh(), GAME_OBJECT_PLAYER);
         _player->SetPlayer(true);
@@ -165,6 +170,16 @@ protected:
         _shadow->SetHidden(false);
         AddGameObject(_shadow);
 
+        // Level objects are world-static, the world scrolls towards the player
+        SetScrollSpeed(0, 0, SPEED_GROUND);
+
+        // Walls hide the objects behind them
+        SetOcclusionCulling(true);
+
+        // Pairs reported by FindCollisions()
+        SetCollisionMask(GAME_OBJECT_PLAYER, COLLISION_ENEMIES | COLLISION_BIT(LEVEL_OBJECT_BULLET) | COLLISION_BIT(LEVEL_OBJECT_LEVEL));
+        SetCollisionMask(LEVEL_OBJECT_PLAYER_BULLET, COLLISION_ENEMIES);
+
         Mat4x4 matProj = MatrixMakeProjection(90.0f, (float)GetScreenHeight() / (float)GetScreenWidth(), 0.1f, 1000.0f);
         SetProjectionMatrix(matProj);
 
@@ -172,14 +187,17 @@ protected:
 
         _state = GAME_INTRO;
 
+        // A new section scrolls in every period, see AddNextSection()
+        AddRepeatingTimer(SECTION_TIME, [this]() { AddNextSection(); });
+
         return true;
     }
 
     virtual bool OnUpdate(float deltaTime) {
+        LogRenderStats();
         RemoveDeadObjects();
 
         if (_state == GAME_INTRO) {
-            AddNextSection(deltaTime);
             IntroScene();
 
             if (IsControlPressed(CONTROL1_BTN1)) {
@@ -214,8 +232,6 @@ protected:
         else if (_state == GAME_END) {
             DrawHUD();
 
-            AddNextSection(deltaTime);
-
             if (IsControlPressed(CONTROL1_BTN4)) {
                 Restart();
             }
@@ -244,8 +260,6 @@ protected:
             DrawShadow();
             DrawHUD();
 
-            AddNextSection(deltaTime);
-
             VerifyGameObjects();
 
             DetectCollisions();
@@ -300,6 +314,7 @@ protected:
 
     void ClearLevel() {
         RemoveGameObjects();
+        ResetScroll();
         AddGameObject(_player);
     }
 
@@ -324,35 +339,32 @@ protected:
 private:
     
     void DetectCollisions() {
-        // Player collisions
-        for (auto gameObject : m_gameObjects) {
-            // Wall detection
-            if (gameObject->GetTag() == LEVEL_OBJECT_LEVEL && !gameObject->IsDead()) {
-                if (_player->IsColliding(*gameObject)) {
-                    // We have a collision between player and wall
-                    PlayerHitObject(gameObject);
-                }
+        // Only confirmed pairs, the engine sorts out the rest
+        for (auto &collision : FindCollisions()) {
+            GameObject* gameObject = collision.object;
+
+            if (gameObject->IsDead()) {
+                continue;
             }
-            
-            // Enemy detection
-            else if (gameObject->GetTag() <= LEVEL_OBJECT_BULLET && !gameObject->IsDead()) {
-                if (_player->IsColliding(*gameObject)) {
-                    // We have a collision between player and enemy
-                    PlayerHitEnemy(gameObject);
+
+            // Player bullet collisions
+            if (collision.projectile >= 0) {
+                if (IsProjectileAlive(collision.projectile)) {
+                    // We have a collision between player bullet and enemy
+                    PlayerBulletHitEnemy(collision.projectile, gameObject);
                 }
             }
-        }
 
-        // Player bullet collisions
-        for (auto bullet : m_bullets) {
-            for (auto gameObject : m_gameObjects) {
-                // Enemy detection
-                if (gameObject->GetTag() < LEVEL_OBJECT_BULLET && !gameObject->IsDead()) {
-                    if (bullet->IsColliding(*gameObject)) {
-                        // We have a collision between player bullet and enemy
-                        PlayerBulletHitEnemy(bullet, gameObject);
-                    }
-                }
+            // Wall detection
+            else if (collision.other->GetTag() == LEVEL_OBJECT_LEVEL) {
+                // We have a collision between player and wall
+                PlayerHitObject(collision.other);
+            }
+
+            // Enemy detection
+            else if (!collision.other->IsDead()) {
+                // We have a collision between player and enemy
+                PlayerHitEnemy(collision.other);
             }
         }
     }
@@ -378,16 +390,19 @@ private:
         _state = PLAYER_HIT;
     }
 
-    void PlayerBulletHitEnemy(GameObject* bullet, GameObject* gameObject) {
+    void PlayerBulletHitEnemy(int bullet, GameObject* gameObject) {
         printf("+++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n");
-        printf("Player bullet <%d> hits enemy <%d>\n", gameObject->GetID());
+        printf("Player bullet <%d> hits enemy <%d>\n", bullet, gameObject->GetID());
         _player->Dump();
         gameObject->Dump();
         printf("+++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n");
 
-        bullet->SetDead();
+        RemoveProjectile(bullet);
         gameObject->SetDead();
 
+        Vec3D center = Vec3DMakef((gameObject->GetMinX() + gameObject->GetMaxX()) / 2, (gameObject->GetMinY() + gameObject->GetMaxY()) / 2, (gameObject->GetMinZ() + gameObject->GetMaxZ()) / 2);
+        AddExplosion(center, gameObject->GetColor());
+
         switch (gameObject->GetTag()) {
             case LEVEL_OBJECT_FUELSILO:
                 _fuel_available += _level.fuel_fillup_per_silo;
@@ -412,22 +427,78 @@ private:
         }
     }
 
-    void DestroyDeadBullets() {
-        int size = (int)m_bullets.size();
-        
-        for (int i = size-1; i >= 0; i--) {
-            if (m_bullets.at(i)->IsDead()) {
-                m_bullets.erase(m_bullets.begin()+i);
+    void RemoveDeadObjects() {
+        for (int i = 0; i < GetGameObjectCount(); i++) {
+            GameObject* gameObject = GetGameObject(i);
+
+            if (gameObject->GetWorldPosition().z < -40) {
+                gameObject->SetDead();
             }
         }
     }
-    
-    void RemoveDeadObjects() {
-        for (auto gameObject : m_gameObjects) {
-            if (gameObject->GetPosition().z < -40) {
-                gameObject->SetDead();
+
+    // Projection cache usage, occlusion culling and edges drawn in edge mode of the state just left
+    void LogRenderStats() {
+        if (_state == _statsState) {
+            return;
+        }
+
+        CacheStats stats = GetCacheStats();
+        long total = stats.hits + stats.misses;
+
+        if (total > 0) {
+            RBLOG_NUM1("Projection cache of state", _statsState);
+            RBLOG_NUM1(" Hit rate (%)", (int)(100 * stats.hits / total));
+            RBLOG_NUM1(" Objects drawn", (int)total);
+            RBLOG_NUM1(" Triangles reused", (int)stats.trianglesReused);
+        }
+
+        OcclusionStats occlusion = GetOcclusionStats();
+
+        if (occlusion.frames > 0) {
+            RBLOG_NUM1("Occlusion culling of state", _statsState);
+            RBLOG_FLOAT1(" Objects culled per frame", (float)occlusion.culled / occlusion.frames);
+            RBLOG_FLOAT1(" Occluder faces per frame", (float)occlusion.occluders / occlusion.frames);
+        }
+
+        CollisionStats collisions = GetCollisionStats();
+
+        if (collisions.frames > 0) {
+            RBLOG_NUM1("Collision detection of state", _statsState);
+            RBLOG_FLOAT1(" Candidate pairs per frame", (float)collisions.candidates / collisions.frames);
+            RBLOG_NUM1(" Collisions", (int)collisions.collisions);
+        }
+
+        PoolStats pool = GetPoolStats();
+
+        if (pool.allocated > 0) {
+            RBLOG_NUM1("Game object pool of state", _statsState);
+            RBLOG_NUM1(" Live", (int)pool.live);
+            RBLOG_NUM1(" Peak", (int)pool.peak);
+            RBLOG_NUM1(" Allocated", (int)pool.allocated);
+            RBLOG_NUM1(" Reused", (int)pool.reused);
+        }
+
+        GameObject* models[] = { _spaceship, _jet, _tank, _rocket };
+        const char* names[] = { "spaceship", "jet", "tank", "rocket" };
+
+        for (int i = 0; i < 4; i++) {
+            EdgeStats& edges = models[i]->GetMesh()->edgeStats;
+
+            if (edges.wireframeEdges > 0) {
+                RBLOG_STR1("Edge mode of model", names[i]);
+                RBLOG_NUM1(" Edges per draw", (int)(edges.edgesDrawn / edges.draws));
+                RBLOG_NUM1(" Wireframe edges per draw", (int)(edges.wireframeEdges / edges.draws));
+                RBLOG_NUM1(" Drawn (%)", (int)(100 * edges.edgesDrawn / edges.wireframeEdges));
             }
+
+            edges = EdgeStats();
         }
+
+        ResetCacheStats();
+        ResetOcclusionStats();
+        ResetCollisionStats();
+        _statsState = _state;
     }
 
     // MARK: - Scenes
@@ -536,81 +607,47 @@ private:
 private:
 
     void AddEndLevel(LevelObject levelObject) {
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_END);
+        GameObject* gameObject = NewGameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_END);
         gameObject->SetPosition(1, GROUND, START_DISTANCE);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
         gameObject->SetHidden(true);
         gameObject->SetColor(colorRed);
-        AddGameObject(gameObject);
+        AddStaticGameObject(gameObject);
 
         RBLOG(" Add end level marker");
     }
 
-    void AddBottomWall(int height) {
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_LEVEL);
-        gameObject->SetPosition(-14, GROUND - height, START_DISTANCE);
-        gameObject->SetScale(29, height, 1);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
-        gameObject->SetColor(colorGreenLight);
-        AddGameObject(gameObject);
+    void AddBottomWall(StaticChunk* chunk, int height) {
+        chunk->AddBox(Vec3DMake(-14, GROUND - height, START_DISTANCE), Vec3DMake(29, height, 1), colorGreenLight);
     }
 
-    void AddTopWall(int height) {
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_LEVEL);
-        gameObject->SetPosition(-14, GROUND - MAX_BORDER_HEIGHT + height - 1, START_DISTANCE);
-        gameObject->SetScale(29, height, 1);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
-        gameObject->SetColor(colorGreenLight);
-        AddGameObject(gameObject);
+    void AddTopWall(StaticChunk* chunk, int height) {
+        chunk->AddBox(Vec3DMake(-14, GROUND - MAX_BORDER_HEIGHT + height - 1, START_DISTANCE), Vec3DMake(29, height, 1), colorGreenLight);
     }
 
-    void AddRightWall() {
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_LEVEL);
-        gameObject->SetPosition(-14, GROUND - MAX_BORDER_HEIGHT, START_DISTANCE);
-        gameObject->SetScale(20, MAX_BORDER_HEIGHT, 1);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
-        gameObject->SetColor(colorGreenLight);
-        AddGameObject(gameObject);
+    void AddRightWall(StaticChunk* chunk) {
+        chunk->AddBox(Vec3DMake(-14, GROUND - MAX_BORDER_HEIGHT, START_DISTANCE), Vec3DMake(20, MAX_BORDER_HEIGHT, 1), colorGreenLight);
     }
 
-    void AddLeftWall() {
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_LEVEL);
-        gameObject->SetPosition(-5, GROUND - MAX_BORDER_HEIGHT, START_DISTANCE);
-        gameObject->SetScale(20, MAX_BORDER_HEIGHT, 1);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
-        gameObject->SetColor(colorGreenLight);
-        AddGameObject(gameObject);
+    void AddLeftWall(StaticChunk* chunk) {
+        chunk->AddBox(Vec3DMake(-5, GROUND - MAX_BORDER_HEIGHT, START_DISTANCE), Vec3DMake(20, MAX_BORDER_HEIGHT, 1), colorGreenLight);
     }
 
-    void AddRightBorderCube(int height) {
+    void AddRightBorderCube(StaticChunk* chunk, int height) {
         if (height == 0) {
-            GameObject* cube;
-            cube = new GameObject(GAME_OBJECT_TYPE_RECTANGLE, LEVEL_OBJECT_LEVEL);
-            cube->SetColor(colorGreen);
-            cube->SetPosition(-15, GROUND - height, START_DISTANCE);
-            cube->SetScale(1, height, 1);
-            cube->SetSpeed(0, 0, SPEED_GROUND);
-            cube->SetColor(colorGreen);
-            AddGameObject(cube);
+            chunk->AddRectangle(Vec3DMake(-15, GROUND - height, START_DISTANCE), Vec3DMake(1, height, 1), colorGreen);
         }
         else {
-            GameObject* cube;
-            cube = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_LEVEL);
-            cube->SetColor(colorGreen);
-            cube->SetPosition(-15, GROUND - height, START_DISTANCE);
-            cube->SetScale(1, height, 1);
-            cube->SetSpeed(0, 0, SPEED_GROUND);
-            AddGameObject(cube);
+            chunk->AddBox(Vec3DMake(-15, GROUND - height, START_DISTANCE), Vec3DMake(1, height, 1), colorGreen);
         }
     }
 
-    void AddLeftBorderCube(int height) {
-        GameObject* cube = new GameObject(GAME_OBJECT_TYPE_CUBE, LEVEL_OBJECT_LEVEL);
-        cube->SetColor(colorGreen);
-        cube->SetPosition(15, GROUND - height, START_DISTANCE);
-        cube->SetScale(1, height, 1);
-        cube->SetSpeed(0, 0, SPEED_GROUND);
-        AddGameObject(cube);
+    void AddLeftBorderCube(StaticChunk* chunk, int height) {
+        chunk->AddBox(Vec3DMake(15, GROUND - height, START_DISTANCE), Vec3DMake(1, height, 1), colorGreen);
+    }
+
+    // All walls and borders of a section are one static chunk
+    void AddSection(StaticChunk* chunk) {
+        AddChunk(chunk, LEVEL_OBJECT_LEVEL);
     }
 
     void AddLevelObject(LevelObject levelObject) {
@@ -644,6 +681,7 @@ private:
 
     void CreateSection(LevelLine line) {
         int height = line.border - 2;
+        StaticChunk* chunk = NewChunk();
 
         // Wall types
         switch (line.border) {
@@ -654,14 +692,14 @@ private:
             // Has border
         case 1:
             RBLOG(" Add small border");
-            AddLeftBorderCube(3);
-            AddRightBorderCube(0);
+            AddLeftBorderCube(chunk, 3);
+            AddRightBorderCube(chunk, 0);
             break;
             // End level border
         case 2:
             RBLOG(" Add end level border");
-            AddLeftBorderCube(1);
-            AddRightBorderCube(1);
+            AddLeftBorderCube(chunk, 1);
+            AddRightBorderCube(chunk, 1);
             break;
             // Has border: height
         case 3:
@@ -672,58 +710,59 @@ private:
         case 8:
         case 9:
             RBLOG_NUM1(" Add wall with height", height);
-            AddLeftBorderCube(MAX_BORDER_HEIGHT);
-            AddRightBorderCube(height + 1);
-            AddBottomWall(height);
+            AddLeftBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddRightBorderCube(chunk, height + 1);
+            AddBottomWall(chunk, height);
             break;
         case 10:
             RBLOG(" Add fly trough wall (X)");
-            AddLeftBorderCube(MAX_BORDER_HEIGHT);
-            AddRightBorderCube(MAX_BORDER_HEIGHT);
-            AddBottomWall(2);
-            AddTopWall(2);
+            AddLeftBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddRightBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddBottomWall(chunk, 2);
+            AddTopWall(chunk, 2);
             break;
         case 11:
             RBLOG(" Add left open wall (Y)");
-            AddLeftBorderCube(MAX_BORDER_HEIGHT);
-            AddRightBorderCube(MAX_BORDER_HEIGHT);
-            AddRightWall();
+            AddLeftBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddRightBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddRightWall(chunk);
             break;
         case 12:
             RBLOG(" Add right open wall (Z)");
-            AddLeftBorderCube(MAX_BORDER_HEIGHT);
-            AddRightBorderCube(MAX_BORDER_HEIGHT);
-            AddLeftWall();
+            AddLeftBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddRightBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddLeftWall(chunk);
             break;
         }
 
+        AddSection(chunk);
+
         for (auto object : line.gameObjects) {
             AddLevelObject(object);
         }
     }
 
-    void AddNextSection(float deltaTime) {
-        _borderDelay += deltaTime;
-
-        if (_borderDelay >= SECTION_TIME) {
-            if (_state == GAME_INTRO) {
-                AddLeftBorderCube(MAX_BORDER_HEIGHT);
-                AddRightBorderCube(MAX_BORDER_HEIGHT);
-            }
-            else if (_state == GAME_END) {
-                AddLeftBorderCube(1);
-                AddRightBorderCube(1);
-            }
-            else {
-                if (_level.HasMoreLines()) {
-                    LevelLine line;
-                    _level.GetLine(line);
+    // Called by the section timer, no new sections while the player is hit or lost
+    void AddNextSection() {
+        if (_state == GAME_INTRO) {
+            StaticChunk* chunk = NewChunk();
+            AddLeftBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddRightBorderCube(chunk, MAX_BORDER_HEIGHT);
+            AddSection(chunk);
+        }
+        else if (_state == GAME_END) {
+            StaticChunk* chunk = NewChunk();
+            AddLeftBorderCube(chunk, 1);
+            AddRightBorderCube(chunk, 1);
+            AddSection(chunk);
+        }
+        else if (_state == GAME_PLAY) {
+            if (_level.HasMoreLines()) {
+                LevelLine line;
+                _level.GetLine(line);
 
-                    CreateSection(line);
-                }
+                CreateSection(line);
             }
-
-            _borderDelay = 0;
         }
     }
 
@@ -733,12 +772,11 @@ private:
     void AddFuelSilo(LevelObject levelObject) {
         int x = -levelObject.x;
 
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, levelObject.type);
+        GameObject* gameObject = NewGameObject(GAME_OBJECT_TYPE_CUBE, levelObject.type);
         gameObject->SetPosition(LEVEL_OFFSET + x, GROUND + 1, START_DISTANCE);
         gameObject->SetScale(2, 3, 2);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
         gameObject->SetColor(colorCyan);
-        AddGameObject(gameObject);
+        AddStaticGameObject(gameObject);
     }
 
     // MARK: - Enemies
@@ -747,7 +785,7 @@ private:
     void AddFlyingJet(LevelObject levelObject) {
         int x = -levelObject.x;
 
-        GameObject* gameObject = new GameObject(GAME_OBJECT_TYPE_CUBE, levelObject.type);
+        GameObject* gameObject = NewGameObject(GAME_OBJECT_TYPE_CUBE, levelObject.type);
         gameObject->SetPosition(LEVEL_OFFSET + x, GROUND - 2, START_DISTANCE);
         gameObject->SetRotationSpeed(2, 0, 0);
         gameObject->SetScale(1, 1, 1);
@@ -759,42 +797,41 @@ private:
     void AddJet(LevelObject levelObject) {
         int x = -levelObject.x;
 
-        GameObject* gameObject = new GameObject(_jet->GetMesh(), levelObject.type);
+        GameObject* gameObject = NewGameObject(_jet->GetMesh(), levelObject.type);
         gameObject->SetPosition(LEVEL_OFFSET + x, GROUND + 1, START_DISTANCE);
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
         gameObject->SetColor(colorRedLight);
-        AddGameObject(gameObject);
+        AddStaticGameObject(gameObject);
     }
 
     void AddRocket(LevelObject levelObject) {
         int x = -levelObject.x;
 
-        GameObject* gameObject = new GameObject(_rocket->GetMesh(), levelObject.type);
+        GameObject* gameObject = NewGameObject(_rocket->GetMesh(), levelObject.type);
         gameObject->SetPosition(LEVEL_OFFSET + x, GROUND + 1, START_DISTANCE);
         gameObject->SetRotation(0, 0, DEG_TO_RAD(-180));
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
         gameObject->SetColor(colorYellow);
-        AddGameObject(gameObject);
+        AddStaticGameObject(gameObject);
     }
 
     void AddTank(LevelObject levelObject) {
         int x = -levelObject.x;
 
-        GameObject* gameObject = new GameObject(_tank->GetMesh(), levelObject.type);
+        GameObject* gameObject = NewGameObject(_tank->GetMesh(), levelObject.type);
         gameObject->SetPosition(LEVEL_OFFSET + x, GROUND + 1, START_DISTANCE);
         gameObject->SetRotation(0, 0, DEG_TO_RAD(-180));
         gameObject->SetColor(colorViolett);
 
-        // Change speed maybe later?
-        gameObject->SetSpeed(0, 0, SPEED_GROUND);
-        AddGameObject(gameObject);
+        // Change speed maybe later? Then it can't be static anymore
+        AddStaticGameObject(gameObject);
     }
     
     void VerifyGameObjects() {
-        for (auto gameObject : m_gameObjects) {
+        for (int i = 0; i < GetGameObjectCount(); i++) {
+            GameObject* gameObject = GetGameObject(i);
+
             // End of level marker
             if (gameObject->GetTag() == LEVEL_OBJECT_END && !gameObject->IsDead()) {
-                if (gameObject->GetPosition().z < DISTANCE_LEVEL_END) {
+                if (gameObject->GetWorldPosition().z < DISTANCE_LEVEL_END) {
                     RBLOG("End of level marker reached");
                     gameObject->SetDead();
                     _state = GAME_END;
@@ -803,7 +840,7 @@ private:
             }
 
             // Enemy alarms
-            if (!gameObject->IsDead() && gameObject->GetPosition().z < DISTANCE_ALARM) {
+            if (!gameObject->IsDead() && gameObject->GetWorldPosition().z < DISTANCE_ALARM) {
                 int tag = gameObject->GetTag();
 
                 switch (tag) {
@@ -830,15 +867,8 @@ private:
     void FireBullet(int offset) {
         Vec3D pos = _player->GetPosition();
 
-        GameObject* cube = new GameObject(_bullet->GetMesh(), LEVEL_OBJECT_BULLET);
-        cube->SetLifeTime(1.0);
-        cube->SetPosition(pos.x + offset, pos.y, pos.z);
-        cube->SetSpeed(0, 0, 60);
-        cube->SetColor(colorYellowLight);
-        AddGameObject(cube);
-        
-        // Add also to bullet list to speed up collision detection
-        m_bullets.push_back(cube);
+        // Drawn as one vector and hit tested along its way, see BroadPhase::Find()
+        FireProjectile(Vec3DMakef(pos.x + offset, pos.y, pos.z), Vec3DMakef(0, 0, 60), 1.0f, colorYellowLight, LEVEL_OBJECT_PLAYER_BULLET);
     }
 
     void FireBullets(int bullets) {
@@ -1002,4 +1032,28 @@ extern "C" {
         return game->SetFilled(code);
     }
 
+    void game_set_edge_mode(int flag) {
+        if (game == NULL) {
+            return;
+        }
+
+        game->SetEdgeMode(flag);
+    }
+
+    void game_set_stereo(int flag) {
+        if (game == NULL) {
+            return;
+        }
+
+        game->SetStereo(flag);
+    }
+
+    void game_run_benchmark() {
+        if (game == NULL) {
+            return;
+        }
+
+        game->BenchmarkPipelines(BENCHMARK_FRAMES);
+    }
+
 }
@@ -12,6 +12,9 @@
 #include "rb_engine.hpp"
 #include "rb_platform.h"
 
+#include <string>
+#include <vector>
+
 extern "C" {
     int vexxon_start();
     int vexxon_frame();
@@ -26,11 +29,32 @@ extern "C" {
     void pitrex_draw_line(float x1, float y1, float x2, float y2);
     void pitrex_draw_text(float x, float y, char* str);
     double pitrex_get_ticks(void);
+    int pitrex_is_stereo(void);
+    int pitrex_imager_index(void);
 }
 
+// In stereo mode a frame is drawn in two refreshes, one per eye. The wheel of the 3D Imager
+// covers the other eye during each of them, so the lines are kept per view until then
+struct PitrexLine {
+    int x1, y1, x2, y2;
+};
+
+struct PitrexText {
+    int x, y;
+    std::string str;
+};
+
+struct PitrexView {
+    std::vector<PitrexLine> lines;
+    std::vector<PitrexText> texts;
+};
+
 char s_asset_path[1024];
 int s_screen_height = 0;
 int s_screen_width = 0;
+PitrexView s_views[3];          // Both eyes, left and right, indexed by view + 1
+int s_view = VIEW_BOTH;
+int s_next_eye = VIEW_LEFT;
 
 void _store_asset_path() {
     const char* home_dir = getenv("HOME");
@@ -39,6 +63,40 @@ void _store_asset_path() {
     RBLOG_STR1("Asset path", s_asset_path);
 }
 
+void _draw_view(PitrexView& view) {
+    for (auto &line : view.lines) {
+        pitrex_draw_line(line.x1, line.y1, line.x2, line.y2);
+    }
+
+    for (auto &text : view.texts) {
+        pitrex_draw_text(text.x, text.y, (char*)text.str.c_str());
+    }
+}
+
+// The first eye is shown by the next refresh, the second one by the refresh after it. The refresh
+// following the index of the wheel belongs to the left eye, the eyes alternate in between
+void _draw_stereo_frame() {
+    for (int i = 0; i < 2; i++) {
+        if (i > 0) {
+            pitrex_frame();
+        }
+
+        if (pitrex_imager_index()) {
+            s_next_eye = VIEW_LEFT;
+        }
+
+        _draw_view(s_views[VIEW_BOTH + 1]);
+        _draw_view(s_views[s_next_eye + 1]);
+
+        s_next_eye = s_next_eye == VIEW_LEFT ? VIEW_RIGHT : VIEW_LEFT;
+    }
+
+    for (auto &view : s_views) {
+        view.lines.clear();
+        view.texts.clear();
+    }
+}
+
 void _game_main() {
     vexxon_start();
 
@@ -49,6 +107,10 @@ void _game_main() {
 
         if (vexxon_frame() == 0) 
             quit = 1;
+
+        if (pitrex_is_stereo()) {
+            _draw_stereo_frame();
+        }
     }
 
     vexxon_stop();
@@ -82,17 +144,37 @@ extern "C" {
 
     void platform_set_pixel(int x, int y, byte color, int brightness) { }
 
+    void platform_get_render_size(int* width, int* height) {
+        *width = s_screen_width;
+        *height = s_screen_height;
+    }
+
     void platform_draw_line(int x1, int y1, int x2, int y2, byte color, int invert) {
         // Must always be inverted on PiTrex platform
         y1 = s_screen_height - y1;
         y2 = s_screen_height - y2;
 
+        if (pitrex_is_stereo()) {
+            s_views[s_view + 1].lines.push_back({ x1, y1, x2, y2 });
+            return;
+        }
+
         pitrex_draw_line(x1, y1, x2, y2);
     }
 
+    // Lines and text of a stereo frame go to the list of the view, see _draw_stereo_frame()
+    void platform_set_view(int view) {
+        s_view = view;
+    }
+
     void vtext_draw_string(int x, int y, char* str, float scale) {
         int xx = 0 - 127 + (254 * x / 362);
         int yy = 0 + 127 - (254 * y / 482);
+
+        if (pitrex_is_stereo()) {
+            s_views[s_view + 1].texts.push_back({ xx, yy, str });
+            return;
+        }
 	        
         pitrex_draw_text((int)xx, (int)yy, str);
     }
@@ -18,6 +18,7 @@
 #include <vectrex/vectrexInterface.h>
 
 void game_set_control_state(int code, int state);
+void game_set_stereo(int flag);
 
 int pitrex_init(const char* name, int width, int height);
 void pitrex_frame(void);
@@ -26,6 +27,8 @@ void pitrex_draw_line(float x1, float y1, float x2, float y2);
 void pitrex_draw_text(float x, float y, char* str);
 double pitrex_get_ticks(void);
 int pitrex_get_brightness(int color);
+int pitrex_is_stereo(void);
+int pitrex_imager_index(void);
 
 #define DEFAULT_TEXT_SIZE       7
 #define DEFAULT_TEXT_SMALL_SIZE 6
@@ -41,6 +44,12 @@ int pitrex_get_brightness(int color);
 #define CONTROL1_JOY_UP      6
 #define CONTROL1_JOY_DOWN    7
 
+// Buttons 1 and 2 of controller 1 pressed together toggle the stereo mode
+#define STEREO_BUTTONS  0x03
+
+// The 3D Imager in port 2 pulses button 4 once per turn of its wheel
+#define IMAGER_INDEX    0x80
+
 #define LIGHT_LOW       80
 #define LIGHT_HIGH      110
 #define LIGHT_DEFAULT   95
@@ -51,6 +60,8 @@ static int _quit = 0;
 static int _time_per_frame = 16;
 static int _screen_width = 0;
 static int _screen_height = 0;
+static int _stereo = 0;
+static int _stereo_buttons = 0;
 
 int pitrex_get_brightness(int color) {    
     int light = (int)(10*color);
@@ -70,6 +81,15 @@ void pitrex_frame(void) {
     v_readJoystick1Analog();
 }
 
+int pitrex_is_stereo(void) {
+    return _stereo;
+}
+
+// True if the wheel passed its index since the last refresh
+int pitrex_imager_index(void) {
+    return (currentButtonState & IMAGER_INDEX) == IMAGER_INDEX;
+}
+
 void pitrex_delay(int64_t ms) {
     // TODO: Implement
 }
@@ -141,9 +161,17 @@ void pitrex_handle_input() {
         game_set_control_state(CONTROL1_JOY_DOWN, 0);
     }    
 
+    // Stereo toggle, the game doesn't see the two buttons while both are down
+    int stereo_buttons = (currentButtonState&STEREO_BUTTONS) == STEREO_BUTTONS;
+    if (stereo_buttons && !_stereo_buttons) {
+        _stereo = !_stereo;
+        game_set_stereo(_stereo);
+    }
+    _stereo_buttons = stereo_buttons;
+
     // Handle buttons from joystick 1
-    game_set_control_state(CONTROL1_BTN1, (currentButtonState&0x01) == (0x01) ? 1 : 0);
-    game_set_control_state(CONTROL1_BTN2, (currentButtonState&0x02) == (0x02) ? 1 : 0);
+    game_set_control_state(CONTROL1_BTN1, (currentButtonState&0x01) == (0x01) && !stereo_buttons ? 1 : 0);
+    game_set_control_state(CONTROL1_BTN2, (currentButtonState&0x02) == (0x02) && !stereo_buttons ? 1 : 0);
     game_set_control_state(CONTROL1_BTN3, (currentButtonState&0x04) == (0x04) ? 1 : 0);
     game_set_control_state(CONTROL1_BTN4, (currentButtonState&0x08) == (0x08) ? 1 : 0);
 }
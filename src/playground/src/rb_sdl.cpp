@@ -14,6 +14,15 @@
 
 #include <string.h>
 #include "SDL.h"
+#include "SDL2_rotozoom.h"
+
+#if defined(__SSSE3__) || defined(_M_X64)
+#include <tmmintrin.h>
+#define SDL_BUFFER_SSSE3
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SDL_BUFFER_NEON
+#endif
 
 #if _WIN32
     extern "C" int win_get_document_path(char* path);
@@ -27,6 +36,9 @@ extern "C" {
     const char* platform_resource_file_path(const char* filename, const char* extension);
     void game_set_control_state(int code, int state);
     void game_set_filled(int code);
+    void game_set_edge_mode(int flag);
+    void game_set_stereo(int flag);
+    void game_run_benchmark();
 }
 
 extern "C" {
@@ -42,7 +54,19 @@ SDL_Renderer* _renderer = NULL;
 SDL_Texture* _texture = NULL;
 SDL_Joystick* _gameController = NULL;
 
+// The buffer is 8-bit indexed, palette color in the high and brightness level in the low nibble
+#define PALETTE_COLORS          16
+#define PALETTE_LEVELS          16
+#define PALETTE_INDEX(color, level) (((color) << 4) | (level))
+
 byte* _pixels = NULL;
+Uint32 _palette[PALETTE_COLORS * PALETTE_LEVELS];
+
+// Palette channel = base * (scale + 1) >> 8, both nibbles of an index are looked up in 16 entry tables
+byte _palette_red[PALETTE_COLORS];
+byte _palette_green[PALETTE_COLORS];
+byte _palette_blue[PALETTE_COLORS];
+byte _palette_scale[PALETTE_LEVELS];
 int _screen_width = 512;
 int _screen_height = 512;
 int _buffer_width = 512;
@@ -50,6 +74,28 @@ int _buffer_height = 512;
 bool _fullscreen = false;
 Uint32 _time_per_frame = 16;
 bool _draw_filled = false;
+bool _draw_edges = false;
+bool _draw_stereo = false;
+int _view = VIEW_BOTH;                  // Stereo views are drawn as red/cyan anaglyph
+
+// Dynamic resolution, the render size follows the measured frame cost
+#define DYNRES_SCALE_MIN        0.5f    // Default lower bound of the render scale
+#define DYNRES_SCALE_STEP       0.05f   // Change of the render scale per adjustment
+#define DYNRES_AVERAGE_WEIGHT   0.1     // Weight of the latest frame in the moving average
+#define DYNRES_TARGET_LOAD      0.75    // Part of the frame time rendering should use
+#define DYNRES_SETTLE_FRAMES    15      // Frames to wait after a change before the next one
+
+int _render_width = 0;
+int _render_height = 0;
+int _render_buffer_width = 512;         // Part of the buffer used at the current scale
+int _render_buffer_height = 512;
+int _render_left = 0;
+float _render_scale = 1.0f;
+float _render_scale_min = DYNRES_SCALE_MIN;
+float _render_scale_max = 1.0f;
+bool _dynamic_resolution = false;
+double _frame_cost = 0;                 // Moving average in ms
+int _frame_settle = 0;
 
 const int JOYSTICK_DEAD_ZONE = 8000;
 
@@ -58,36 +104,193 @@ bool _shift_key = false;
 bool _alt_key = false;
 bool _quit = false;
 
+// The brightness levels scale the full color in integer steps, so the table and the SIMD expansion
+// give the same pixels, within one step of GetPaletteColor() with the brightness of the level
+void _sdl_create_palette() {
+    for (int color = 0; color < PALETTE_COLORS; color++) {
+        VecRGB rgb = GetPaletteColor(color, BRIGHTNESS_OFF);
+
+        _palette_red[color] = rgb.r;
+        _palette_green[color] = rgb.g;
+        _palette_blue[color] = rgb.b;
+    }
+
+    for (int level = 0; level < PALETTE_LEVELS; level++) {
+        int brightness = level == PALETTE_LEVELS - 1 ? 100 : level * 100 / (PALETTE_LEVELS - 1);
+        int scale = brightness * 256 / 100 - 1;
+
+        _palette_scale[level] = scale < 0 ? 0 : scale;
+    }
+
+    for (int color = 0; color < PALETTE_COLORS; color++) {
+        for (int level = 0; level < PALETTE_LEVELS; level++) {
+            int scale = _palette_scale[level] + 1;
+            Uint32 r = (_palette_red[color] * scale) >> 8;
+            Uint32 g = (_palette_green[color] * scale) >> 8;
+            Uint32 b = (_palette_blue[color] * scale) >> 8;
+
+            _palette[PALETTE_INDEX(color, level)] = 0xff000000 | (r << 16) | (g << 8) | b;
+        }
+    }
+
+    // Cleared buffer, as before
+    _palette[0] = 0;
+}
+
+#if defined(SDL_BUFFER_SSSE3)
+// 16 channel values, base * (scale + 1) >> 8 in 16 bit lanes
+static inline __m128i _sdl_scale_channel(__m128i base, __m128i scale) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low = _mm_unpacklo_epi8(base, zero);
+    __m128i high = _mm_unpackhi_epi8(base, zero);
+
+    low = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(low, _mm_unpacklo_epi8(scale, zero)), low), 8);
+    high = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(high, _mm_unpackhi_epi8(scale, zero)), high), 8);
+
+    return _mm_packus_epi16(low, high);
+}
+
+// 16 indices into 16 ARGB pixels, the nibbles select the base color and the scale with byte shuffles
+static inline void _sdl_expand16(const byte* src, Uint32* dst) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    __m128i indices = _mm_loadu_si128((const __m128i*)src);
+    __m128i level = _mm_and_si128(indices, mask);
+    __m128i color = _mm_and_si128(_mm_srli_epi16(indices, 4), mask);
+    __m128i scale = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)_palette_scale), level);
+
+    __m128i r = _sdl_scale_channel(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)_palette_red), color), scale);
+    __m128i g = _sdl_scale_channel(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)_palette_green), color), scale);
+    __m128i b = _sdl_scale_channel(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)_palette_blue), color), scale);
+    __m128i a = _mm_xor_si128(_mm_cmpeq_epi8(indices, _mm_setzero_si128()), _mm_set1_epi8(-1));
+
+    // Bytes in memory order b, g, r, a of ARGB8888
+    __m128i bg = _mm_unpacklo_epi8(b, g);
+    __m128i ra = _mm_unpacklo_epi8(r, a);
+    _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 4), _mm_unpackhi_epi16(bg, ra));
+
+    bg = _mm_unpackhi_epi8(b, g);
+    ra = _mm_unpackhi_epi8(r, a);
+    _mm_storeu_si128((__m128i*)(dst + 8), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 12), _mm_unpackhi_epi16(bg, ra));
+}
+#elif defined(SDL_BUFFER_NEON)
+static inline uint8x16_t _sdl_lookup16(const byte* table, uint8x16_t index) {
+#if defined(__aarch64__)
+    return vqtbl1q_u8(vld1q_u8(table), index);
+#else
+    uint8x8x2_t t = { { vld1_u8(table), vld1_u8(table + 8) } };
+    return vcombine_u8(vtbl2_u8(t, vget_low_u8(index)), vtbl2_u8(t, vget_high_u8(index)));
+#endif
+}
+
+// base * (scale + 1) >> 8
+static inline uint8x16_t _sdl_scale_channel(uint8x16_t base, uint8x16_t scale) {
+    uint16x8_t low = vaddw_u8(vmull_u8(vget_low_u8(base), vget_low_u8(scale)), vget_low_u8(base));
+    uint16x8_t high = vaddw_u8(vmull_u8(vget_high_u8(base), vget_high_u8(scale)), vget_high_u8(base));
+
+    return vcombine_u8(vshrn_n_u16(low, 8), vshrn_n_u16(high, 8));
+}
+
+// 16 indices into 16 ARGB pixels, the nibbles select the base color and the scale with table lookups
+static inline void _sdl_expand16(const byte* src, Uint32* dst) {
+    uint8x16_t indices = vld1q_u8(src);
+    uint8x16_t level = vandq_u8(indices, vdupq_n_u8(0x0f));
+    uint8x16_t color = vshrq_n_u8(indices, 4);
+    uint8x16_t scale = _sdl_lookup16(_palette_scale, level);
+
+    // Bytes in memory order b, g, r, a of ARGB8888
+    uint8x16x4_t pixels;
+    pixels.val[0] = _sdl_scale_channel(_sdl_lookup16(_palette_blue, color), scale);
+    pixels.val[1] = _sdl_scale_channel(_sdl_lookup16(_palette_green, color), scale);
+    pixels.val[2] = _sdl_scale_channel(_sdl_lookup16(_palette_red, color), scale);
+    pixels.val[3] = vmvnq_u8(vceqq_u8(indices, vdupq_n_u8(0)));
+    vst4q_u8((byte*)dst, pixels);
+}
+#endif
+
 void _sdl_create_buffer() {
-    _pixels = (byte*)malloc(_buffer_width * _buffer_height * 4);
-    _texture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, _buffer_width, _buffer_height);
+    _sdl_create_palette();
+
+    _pixels = (byte*)malloc(_buffer_width * _buffer_height);
+    _texture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, _buffer_width, _buffer_height);
 }
 
 void _sdl_clear_buffer(byte color) {
     if (_pixels == nullptr) return;
-    memset(_pixels, color, _buffer_width * _buffer_height * 4);
+    memset(_pixels, color, _buffer_width * _render_buffer_height);
 }
 
+// Expand the used part of the indexed buffer into the texture, 16 pixels at a time with SSSE3 or NEON.
+// Cleared runs are only stored, they cover most of the screen in wireframe mode
+void _sdl_upload_buffer() {
+    SDL_Rect render_rect = { 0, 0, _render_buffer_width, _render_buffer_height };
+    void* texture_pixels;
+    int texture_pitch;
+
+    if (SDL_LockTexture(_texture, &render_rect, &texture_pixels, &texture_pitch) != 0) {
+        return;
+    }
+
+    for (int y = 0; y < _render_buffer_height; y++) {
+        const byte* src = _pixels + y * _buffer_width;
+        Uint32* dst = (Uint32*)((byte*)texture_pixels + y * texture_pitch);
+        int x = 0;
+
+#if defined(SDL_BUFFER_SSSE3)
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 16 <= _render_buffer_width; x += 16) {
+            __m128i indices = _mm_loadu_si128((const __m128i*)(src + x));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(indices, zero)) == 0xffff) {
+                _mm_storeu_si128((__m128i*)(dst + x), zero);
+                _mm_storeu_si128((__m128i*)(dst + x + 4), zero);
+                _mm_storeu_si128((__m128i*)(dst + x + 8), zero);
+                _mm_storeu_si128((__m128i*)(dst + x + 12), zero);
+                continue;
+            }
+            _sdl_expand16(src + x, dst + x);
+        }
+#elif defined(SDL_BUFFER_NEON)
+        const uint32x4_t zero = vdupq_n_u32(0);
+        for (; x + 16 <= _render_buffer_width; x += 16) {
+            uint64x2_t indices = vreinterpretq_u64_u8(vld1q_u8(src + x));
+            if ((vgetq_lane_u64(indices, 0) | vgetq_lane_u64(indices, 1)) == 0) {
+                vst1q_u32(dst + x, zero);
+                vst1q_u32(dst + x + 4, zero);
+                vst1q_u32(dst + x + 8, zero);
+                vst1q_u32(dst + x + 12, zero);
+                continue;
+            }
+            _sdl_expand16(src + x, dst + x);
+        }
+#endif
+        for (; x < _render_buffer_width; x++) {
+            dst[x] = _palette[src[x]];
+        }
+    }
+
+    SDL_UnlockTexture(_texture);
+}
+
+// x/y are in render coordinates, the render area is centered in the used part of the buffer
 void _sdl_set_pixel(int x, int y, byte color, int brightness) {
     if (_pixels == nullptr) return;
 
-    if (x > _screen_width || x <= 0) return;
-    if (y > _screen_height || y <= 0) return;
+    if (x > _render_width || x <= 0) return;
+    if (y > _render_height || y <= 0) return;
 
-    static int left = (_buffer_width - _screen_width) / 2;
-    static int top = (_buffer_height - _screen_height) / 2;
+    x += _render_left;
+    y = _render_height - y;
 
-    x += left;
-    y = _screen_height - y;
+    // Colors outside the palette are drawn white, like GetPaletteColor() does
+    if (color >= PALETTE_COLORS) color = colorWhite;
 
-    VecRGB rgb = GetPaletteColor(color, brightness);
+    int level = PALETTE_LEVELS - 1;
+    if (brightness < BRIGHTNESS_OFF) {
+        level = brightness <= 0 ? 0 : (brightness * (PALETTE_LEVELS - 1) + 50) / 100;
+    }
 
-    int height = _buffer_height;
- 
-    _pixels[(y * height + x) * 4] = rgb.b;
-    _pixels[(y * height + x) * 4 + 1] = rgb.g;
-    _pixels[(y * height + x) * 4 + 2] = rgb.r;
-    _pixels[(y * height + x) * 4 + 3] = 255;
+    _pixels[y * _buffer_width + x] = PALETTE_INDEX(color, level);
 }
 
 void _sdl_draw_line(int x1, int y1, int x2, int y2, byte color) {
@@ -120,6 +323,67 @@ void _sdl_set_fps(int fps) {
     _time_per_frame = 1000 / fps;
 }
 
+// MARK: - Dynamic resolution
+
+void _sdl_set_render_scale(float scale) {
+    if (scale < _render_scale_min) scale = _render_scale_min;
+    if (scale > _render_scale_max) scale = _render_scale_max;
+
+    _render_scale = scale;
+    _render_width = (int)(_screen_width * scale);
+    _render_height = (int)(_screen_height * scale);
+    _render_buffer_width = (int)(_buffer_width * scale);
+    _render_buffer_height = (int)(_buffer_height * scale);
+    _render_left = (_render_buffer_width - _render_width) / 2;
+}
+
+void _sdl_set_dynamic_resolution(bool flag, float min, float max) {
+    // The buffer is never enlarged, so the scale can't go above 1
+    if (max > 1.0f || max <= 0.0f) max = 1.0f;
+    if (min > max || min <= 0.0f) min = max;
+
+    _dynamic_resolution = flag;
+    _render_scale_min = flag ? min : 1.0f;
+    _render_scale_max = flag ? max : 1.0f;
+    _frame_cost = 0;
+    _frame_settle = DYNRES_SETTLE_FRAMES;
+
+    _sdl_set_render_scale(_render_scale_max);
+
+    RBLOG_NUM1("Dynamic resolution ", flag);
+}
+
+// Called once per frame with the time spent rendering the frame
+void _sdl_update_dynamic_resolution(double cost) {
+    if (!_dynamic_resolution) return;
+
+    _frame_cost = _frame_cost > 0 ? _frame_cost + (cost - _frame_cost) * DYNRES_AVERAGE_WEIGHT : cost;
+
+    if (_frame_settle > 0) {
+        _frame_settle--;
+        return;
+    }
+
+    double target = _time_per_frame * DYNRES_TARGET_LOAD;
+    float scale = _render_scale;
+
+    // Cost scales with the rendered area, so only grow when the larger size still fits
+    if (_frame_cost > target) {
+        scale -= DYNRES_SCALE_STEP;
+    }
+    else if (_frame_cost * (scale + DYNRES_SCALE_STEP) * (scale + DYNRES_SCALE_STEP) < target * scale * scale) {
+        scale += DYNRES_SCALE_STEP;
+    }
+
+    if (scale < _render_scale_min) scale = _render_scale_min;
+    if (scale > _render_scale_max) scale = _render_scale_max;
+
+    if (scale != _render_scale) {
+        _sdl_set_render_scale(scale);
+        _frame_settle = DYNRES_SETTLE_FRAMES;
+    }
+}
+
 int _sdl_init(int width, int height, int buffer_width, int buffer_height) {
     RBLOG("sdl_init()");
 
@@ -164,6 +428,8 @@ int _sdl_init(int width, int height, int buffer_width, int buffer_height) {
         RBLOG_NUM1("Set screen height", _screen_height);
 	}
 
+    _sdl_set_render_scale(_render_scale_max);
+
     _window = SDL_CreateWindow("PLAYGROUND", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, _buffer_width, _buffer_height, 0);
  
     Uint32 render_flags = SDL_RENDERER_ACCELERATED;
@@ -238,6 +504,20 @@ bool _sdl_handle_keydown_event(SDL_Event event) {
                 game_set_filled(_draw_filled);
             }
             break;
+        case SDLK_r:
+            _sdl_set_dynamic_resolution(!_dynamic_resolution, DYNRES_SCALE_MIN, 1.0f);
+            break;
+        case SDLK_e:
+            _draw_edges = !_draw_edges;
+            game_set_edge_mode(_draw_edges);
+            break;
+        case SDLK_s:
+            _draw_stereo = !_draw_stereo;
+            game_set_stereo(_draw_stereo);
+            break;
+        case SDLK_b:
+            game_run_benchmark();
+            break;
 
         case SDLK_LEFT:
             game_set_control_state(CONTROL1_JOY_LEFT, true);
@@ -368,12 +648,20 @@ int _sdl_run() {
         }
 
         if (!_quit) {
+            Uint64 frame_start = SDL_GetPerformanceCounter();
+
             SDL_RenderClear(_renderer);
             
             vexxon_frame();
 
-            SDL_UpdateTexture(_texture, NULL, _pixels, _buffer_width * sizeof(Uint32));
-            SDL_RenderCopy(_renderer, _texture, NULL, NULL);
+            // Upscale the used part of the buffer to the window
+            SDL_Rect render_rect = { 0, 0, _render_buffer_width, _render_buffer_height };
+            _sdl_upload_buffer();
+            SDL_RenderCopy(_renderer, _texture, &render_rect, NULL);
+
+            double frame_cost = (SDL_GetPerformanceCounter() - frame_start) * 1000.0 / SDL_GetPerformanceFrequency();
+            _sdl_update_dynamic_resolution(frame_cost);
+
             SDL_RenderPresent(_renderer);
 
             _time_per_frame = 100;
@@ -441,9 +729,56 @@ void _store_asset_path() {
     RBLOG_STR1("Asset path", s_asset_path);
 }
 
+// Scale the 512x512 buffer up to full-screen sizes, single-threaded versus all cores
+int _sdl_benchmark_zoom() {
+    const int sizes[][2] = { {1920, 1080}, {3840, 2160} };
+    const int runs = 20;
+
+    SDL_Surface* buffer = SDL_CreateRGBSurface(0, _buffer_width, _buffer_height, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    if (buffer == NULL) {
+        RBLOG_STR1("Error creating benchmark surface: ", SDL_GetError());
+        return -1;
+    }
+
+    for (int i = 0; i < _buffer_width * _buffer_height; i++) {
+        ((Uint32*)buffer->pixels)[i] = (i * 2654435761u) | 0xff000000;
+    }
+
+    for (int s = 0; s < 2; s++) {
+        double zoomx = (double)sizes[s][0] / _buffer_width;
+        double zoomy = (double)sizes[s][1] / _buffer_height;
+
+        RBLOG_NUM1("Zoom buffer to width ", sizes[s][0]);
+        for (int threads = 1; threads >= 0; threads--) {
+            rotozoomSetThreads(threads);
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            for (int r = 0; r < runs; r++) {
+                SDL_FreeSurface(zoomSurface(buffer, zoomx, zoomy, SMOOTHING_ON));
+            }
+            Uint64 end = SDL_GetPerformanceCounter();
+
+            float ms = (float)((end - start) * 1000.0 / SDL_GetPerformanceFrequency() / runs);
+            RBLOG_FLOAT1(threads == 1 ? "  ms per frame, 1 thread  " : "  ms per frame, all cores ", ms);
+        }
+    }
+
+    SDL_FreeSurface(buffer);
+
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
-    UNUSED_VAR(argc);
-    UNUSED_VAR(argv);
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+        return _sdl_benchmark_zoom();
+    }
+
+    // --dynres [min max], render scale bounds default to 0.5 and 1.0
+    if (argc > 1 && strcmp(argv[1], "--dynres") == 0) {
+        float min = argc > 3 ? atof(argv[2]) : DYNRES_SCALE_MIN;
+        float max = argc > 3 ? atof(argv[3]) : 1.0f;
+        _sdl_set_dynamic_resolution(true, min, max);
+    }
 
     _store_asset_path();
 
@@ -473,8 +808,12 @@ extern "C" {
 
     void platform_draw_line(int x1, int y1, int x2, int y2, byte color, int invert) {
         if (invert == INVERT_ON) {
-            y1 = _screen_height - y1;
-            y2 = _screen_height - y2;
+            y1 = _render_height - y1;
+            y2 = _render_height - y2;
+        }
+
+        if (_view != VIEW_BOTH && invert == INVERT_OFF) {
+            color = _view == VIEW_LEFT ? colorRed : colorCyan;
         }
 
         _sdl_draw_line(x1, y1, x2, y2, color);
@@ -492,6 +831,10 @@ extern "C" {
 #endif
     }
 
+    void platform_set_view(int view) {
+        _view = view;
+    }
+
     byte platform_get_input(byte code) {
         UNUSED_VAR(code);
         return 0;
@@ -515,6 +858,11 @@ extern "C" {
         return SDL_GetTicks();
     }
 
+    void platform_get_render_size(int* width, int* height) {
+        *width = _render_width;
+        *height = _render_height;
+    }
+
     // Events
     void platform_on_init(const char* name, int width, int height) {
         platform_set_window_title(name);
@@ -60,6 +60,266 @@ typedef struct {
 	Sint16 last1x, last1y, last2x, last2y, first1x, first1y, first2x, first2y, tempx, tempy;
 } SDL2_gfxMurphyIterator;
 
+/*!
+\brief The structure holding all points and spans of one color of a batch.
+*/
+typedef struct {
+	Uint32 key;		/* color as 0xRRGGBBAA */
+	SDL_Point *points;
+	int numPoints, maxPoints;
+	SDL_Rect *rects;
+	int numRects, maxRects;
+} SDL2_gfxBatchBucket;
+
+/*!
+\brief The structure collecting the output of the batch drawing functions.
+
+Points and spans are grouped by color/alpha and submitted with one
+SDL_RenderDrawPoints/SDL_RenderFillRects call per group on flush.
+If pixels is set, the batch renders into this ARGB8888 buffer instead.
+*/
+struct SDL2_gfxBatch {
+	SDL_Renderer *renderer;
+	Uint32 *pixels;
+	int width, height, pitch;
+	SDL2_gfxBatchBucket *buckets;
+	int numBuckets, maxBuckets;
+	int *slots;		/* hash of color to bucket index, -1 if unused */
+	int numSlots;
+	int last;		/* index of most recently used bucket */
+	Uint8 r, g, b, a;	/* color used by pixel(), hlineDraw() and line() */
+};
+
+/* ---- Batching */
+
+/*!
+\brief Batch that captures the output of the primitives, NULL if drawing goes to the renderer.
+*/
+static SDL2_gfxBatch *gfxPrimitivesBatch = NULL;
+
+/*!
+\brief Internal function to grow a batch array.
+
+\param array Pointer to the array.
+\param max Pointer to the allocated number of elements.
+\param size The size of one element.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+static int _gfxBatchGrow(void **array, int *max, size_t size)
+{
+	int newMax = (*max == 0) ? 256 : *max * 2;
+	void *newArray = realloc(*array, newMax * size);
+	if (newArray == NULL) {
+		return (-1);
+	}
+
+	*array = newArray;
+	*max = newMax;
+
+	return (0);
+}
+
+/*!
+\brief Internal function to find (or create) the bucket of a color.
+
+\param batch The batch.
+\param key The color value (0xRRGGBBAA).
+
+\returns Returns the bucket index or -1 on failure.
+*/
+static int _gfxBatchBucket(SDL2_gfxBatch *batch, Uint32 key)
+{
+	int i, slot, mask;
+	int *newSlots;
+	SDL2_gfxBatchBucket *bucket;
+
+	if ((batch->last >= 0) && (batch->buckets[batch->last].key == key)) {
+		return (batch->last);
+	}
+
+	/*
+	* Keep hash at most half full 
+	*/
+	if (batch->numBuckets * 2 >= batch->numSlots) {
+		newSlots = (int *) malloc(sizeof(int) * (batch->numSlots ? batch->numSlots * 2 : 64));
+		if (newSlots == NULL) {
+			return (-1);
+		}
+		free(batch->slots);
+		batch->slots = newSlots;
+		batch->numSlots = batch->numSlots ? batch->numSlots * 2 : 64;
+		mask = batch->numSlots - 1;
+		for (i = 0; i < batch->numSlots; i++) {
+			batch->slots[i] = -1;
+		}
+		for (i = 0; i < batch->numBuckets; i++) {
+			slot = (int)((batch->buckets[i].key * 2654435761u) >> 16) & mask;
+			while (batch->slots[slot] >= 0) {
+				slot = (slot + 1) & mask;
+			}
+			batch->slots[slot] = i;
+		}
+	}
+
+	mask = batch->numSlots - 1;
+	slot = (int)((key * 2654435761u) >> 16) & mask;
+	while (batch->slots[slot] >= 0) {
+		if (batch->buckets[batch->slots[slot]].key == key) {
+			batch->last = batch->slots[slot];
+			return (batch->last);
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	/*
+	* New color 
+	*/
+	if (batch->numBuckets >= batch->maxBuckets) {
+		if (_gfxBatchGrow((void **)&batch->buckets, &batch->maxBuckets, sizeof(SDL2_gfxBatchBucket))) {
+			return (-1);
+		}
+	}
+
+	bucket = &batch->buckets[batch->numBuckets];
+	memset(bucket, 0, sizeof(SDL2_gfxBatchBucket));
+	bucket->key = key;
+	batch->slots[slot] = batch->numBuckets;
+	batch->last = batch->numBuckets++;
+
+	return (batch->last);
+}
+
+/*!
+\brief Internal function to add a point to a batch.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+static int _gfxBatchPoint(SDL2_gfxBatch *batch, Sint16 x, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	SDL2_gfxBatchBucket *bucket;
+	int index = _gfxBatchBucket(batch, ((Uint32)r << 24) | ((Uint32)g << 16) | ((Uint32)b << 8) | a);
+	if (index < 0) {
+		return (-1);
+	}
+
+	bucket = &batch->buckets[index];
+	if (bucket->numPoints >= bucket->maxPoints) {
+		if (_gfxBatchGrow((void **)&bucket->points, &bucket->maxPoints, sizeof(SDL_Point))) {
+			return (-1);
+		}
+	}
+
+	bucket->points[bucket->numPoints].x = x;
+	bucket->points[bucket->numPoints].y = y;
+	bucket->numPoints++;
+
+	return (0);
+}
+
+/*!
+\brief Internal function to add a span (filled rectangle) to a batch.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+static int _gfxBatchRect(SDL2_gfxBatch *batch, int x1, int y1, int x2, int y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int tmp;
+	SDL2_gfxBatchBucket *bucket;
+	int index = _gfxBatchBucket(batch, ((Uint32)r << 24) | ((Uint32)g << 16) | ((Uint32)b << 8) | a);
+	if (index < 0) {
+		return (-1);
+	}
+
+	if (x1 > x2) {
+		tmp = x1;
+		x1 = x2;
+		x2 = tmp;
+	}
+	if (y1 > y2) {
+		tmp = y1;
+		y1 = y2;
+		y2 = tmp;
+	}
+
+	bucket = &batch->buckets[index];
+	if (bucket->numRects >= bucket->maxRects) {
+		if (_gfxBatchGrow((void **)&bucket->rects, &bucket->maxRects, sizeof(SDL_Rect))) {
+			return (-1);
+		}
+	}
+
+	bucket->rects[bucket->numRects].x = x1;
+	bucket->rects[bucket->numRects].y = y1;
+	bucket->rects[bucket->numRects].w = x2 - x1 + 1;
+	bucket->rects[bucket->numRects].h = y2 - y1 + 1;
+	bucket->numRects++;
+
+	return (0);
+}
+
+/*!
+\brief Internal function to add a line to a batch; straight lines become spans, all others points.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+static int _gfxBatchLine(SDL2_gfxBatch *batch, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result;
+	int dx, dy, sx, sy, err, e2;
+
+	if ((x1 == x2) || (y1 == y2)) {
+		return (_gfxBatchRect(batch, x1, y1, x2, y2, r, g, b, a));
+	}
+
+	dx = abs(x2 - x1);
+	dy = -abs(y2 - y1);
+	sx = (x1 < x2) ? 1 : -1;
+	sy = (y1 < y2) ? 1 : -1;
+	err = dx + dy;
+
+	result = 0;
+	while (1) {
+		result |= _gfxBatchPoint(batch, x1, y1, r, g, b, a);
+		if ((x1 == x2) && (y1 == y2)) {
+			break;
+		}
+		e2 = 2 * err;
+		if (e2 >= dy) {
+			err += dy;
+			x1 += sx;
+		}
+		if (e2 <= dx) {
+			err += dx;
+			y1 += sy;
+		}
+	}
+
+	return (result);
+}
+
+/*!
+\brief Internal function to set the draw color, or the color of the active batch.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+static int _gfxSetDrawColor(SDL_Renderer *renderer, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result = 0;
+
+	if (gfxPrimitivesBatch != NULL) {
+		gfxPrimitivesBatch->r = r;
+		gfxPrimitivesBatch->g = g;
+		gfxPrimitivesBatch->b = b;
+		gfxPrimitivesBatch->a = a;
+		return (0);
+	}
+
+	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	return (result);
+}
+
 /* ---- Pixel */
 
 /*!
@@ -73,6 +333,10 @@ typedef struct {
 */
 int pixel(SDL_Renderer *renderer, Sint16 x, Sint16 y)
 {
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchPoint(gfxPrimitivesBatch, x, y, gfxPrimitivesBatch->r, gfxPrimitivesBatch->g, gfxPrimitivesBatch->b, gfxPrimitivesBatch->a);
+	}
+
 	return SDL_RenderDrawPoint(renderer, x, y);
 }
 
@@ -108,6 +372,10 @@ int pixelColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, Uint32 color)
 int pixelRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
 	int result = 0;
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchPoint(gfxPrimitivesBatch, x, y, r, g, b, a);
+	}
+
 	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
 	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);
 	result |= SDL_RenderDrawPoint(renderer, x, y);
@@ -158,6 +426,10 @@ int pixelRGBAWeight(SDL_Renderer * renderer, Sint16 x, Sint16 y, Uint8 r, Uint8
 */
 int hlineDraw(SDL_Renderer * renderer, Sint16 x1, Sint16 x2, Sint16 y)
 {
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchRect(gfxPrimitivesBatch, x1, y, x2, y, gfxPrimitivesBatch->r, gfxPrimitivesBatch->g, gfxPrimitivesBatch->b, gfxPrimitivesBatch->a);
+	}
+
 	return SDL_RenderDrawLine(renderer, x1, y, x2, y);
 }
 
@@ -196,6 +468,10 @@ int hlineColor(SDL_Renderer * renderer, Sint16 x1, Sint16 x2, Sint16 y, Uint32 c
 int hlineRGBA(SDL_Renderer * renderer, Sint16 x1, Sint16 x2, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
 	int result = 0;
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchRect(gfxPrimitivesBatch, x1, y, x2, y, r, g, b, a);
+	}
+
 	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
 	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);
 	result |= SDL_RenderDrawLine(renderer, x1, y, x2, y);
@@ -238,6 +514,10 @@ int vlineColor(SDL_Renderer * renderer, Sint16 x, Sint16 y1, Sint16 y2, Uint32 c
 int vlineRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y1, Sint16 y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
 	int result = 0;
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchRect(gfxPrimitivesBatch, x, y1, x, y2, r, g, b, a);
+	}
+
 	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
 	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);
 	result |= SDL_RenderDrawLine(renderer, x, y1, x, y2);
@@ -764,6 +1044,10 @@ int boxRGBA(SDL_Renderer * renderer, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2,
 	/*
 	* Draw
 	*/
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchRect(gfxPrimitivesBatch, x1, y1, x2, y2, r, g, b, a);
+	}
+
 	result = 0;
 	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
 	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);	
@@ -789,6 +1073,10 @@ int line(SDL_Renderer * renderer, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2)
 	/*
 	* Draw
 	*/
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchLine(gfxPrimitivesBatch, x1, y1, x2, y2, gfxPrimitivesBatch->r, gfxPrimitivesBatch->g, gfxPrimitivesBatch->b, gfxPrimitivesBatch->a);
+	}
+
 	return SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
 }
 
@@ -831,6 +1119,10 @@ int lineRGBA(SDL_Renderer * renderer, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2
 	* Draw
 	*/
 	int result = 0;
+	if (gfxPrimitivesBatch != NULL) {
+		return _gfxBatchLine(gfxPrimitivesBatch, x1, y1, x2, y2, r, g, b, a);
+	}
+
 	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
 	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);	
 	result |= SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
@@ -1865,7 +2157,7 @@ int aaellipseRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, Sint16 rx, Sint16
 
 	/* Draw */
 	result = 0;
-	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+	result |= _gfxSetDrawColor(renderer, r, g, b, a);
 
 	/* "End points" */
 	result |= pixelRGBA(renderer, xp, yp, r, g, b, a);
@@ -2971,8 +3263,7 @@ int filledPolygonRGBAMT(SDL_Renderer * renderer, const Sint16 * vx, const Sint16
 		* Set color 
 		*/
 		result = 0;
-	    result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
-		result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);	
+		result |= _gfxSetDrawColor(renderer, r, g, b, a);
 
 		for (i = 0; (i < ints); i += 2) {
 			xa = gfxPrimitivesPolyInts[i] + 1;
@@ -3476,9 +3767,42 @@ int texturedPolygon2(SDL_Renderer *renderer, const Sint16 * vx, const Sint16 * v
 /* ---- Character */
 
 /*!
-\brief Global cache for NxM pixel font textures created at runtime.
+\brief Maximum number of font atlases kept in the glyph cache.
+*/
+#define GFX_FONT_ATLAS_MAX 8
+
+/*!
+\brief Maximum number of characters submitted per geometry call by stringRGBA.
+*/
+#define GFX_FONT_STRING_CHUNK 64
+
+/*!
+\brief Texture atlas holding all 256 glyphs of one font in a 16x16 grid.
+*/
+typedef struct {
+	SDL_Renderer *renderer;
+	SDL_Texture *texture;
+	const unsigned char *fontdata;
+	Uint32 width;
+	Uint32 height;
+	Uint32 rotation;
+	Uint32 age;
+} SDL2_gfxFontAtlas;
+
+/*!
+\brief Global cache of font atlases created at runtime.
+*/
+static SDL2_gfxFontAtlas gfxPrimitivesFontAtlas[GFX_FONT_ATLAS_MAX];
+
+/*!
+\brief Atlas of the current font, rotation and renderer. NULL if not looked up yet.
 */
-static SDL_Texture *gfxPrimitivesFont[256];
+static SDL2_gfxFontAtlas *gfxPrimitivesCurrentAtlas = NULL;
+
+/*!
+\brief Counter used to find the least recently selected atlas.
+*/
+static Uint32 gfxPrimitivesFontAge = 0;
 
 /*!
 \brief Pointer to the current font data. Default is a 8x8 pixel internal font. 
@@ -3529,14 +3853,14 @@ The font data array is organized in follows:
 [byte n] = [bit 0]...[bit 7] where 
 [bit n] = [0 for transparent pixel|1 for colored pixel]
 
+Glyph atlases of previously used fonts stay cached, so switching fonts is cheap.
+
 \param fontdata Pointer to array of font data. Set to NULL, to reset global font to the default 8x8 font.
 \param cw Width of character in bytes. Ignored if fontdata==NULL.
 \param ch Height of character in bytes. Ignored if fontdata==NULL.
 */
 void gfxPrimitivesSetFont(const void *fontdata, Uint32 cw, Uint32 ch)
 {
-	int i;
-
 	if ((fontdata) && (cw) && (ch)) {
 		currentFontdata = (unsigned char *)fontdata;
 		charWidth = cw;
@@ -3562,27 +3886,20 @@ void gfxPrimitivesSetFont(const void *fontdata, Uint32 cw, Uint32 ch)
 		charHeightLocal = charHeight;
 	}
 
-	/* Clear character cache */
-	for (i = 0; i < 256; i++) {
-		if (gfxPrimitivesFont[i]) {
-			SDL_DestroyTexture(gfxPrimitivesFont[i]);
-			gfxPrimitivesFont[i] = NULL;
-		}
-	}
+	/* Select atlas on next draw */
+	gfxPrimitivesCurrentAtlas = NULL;
 }
 
 /*!
 \brief Sets current global font character rotation steps. 
 
 Default is 0 (no rotation). 1 = 90deg clockwise. 2 = 180deg clockwise. 3 = 270deg clockwise.
-Changing the rotation, will reset the character cache.
+Each rotation uses its own glyph atlas.
 
 \param rotation Number of 90deg clockwise steps to rotate
 */
 void gfxPrimitivesSetFontRotation(Uint32 rotation)
 {
-	int i;
-
 	rotation = rotation & 3;
 	if (charRotation != rotation)
 	{
@@ -3601,161 +3918,222 @@ void gfxPrimitivesSetFontRotation(Uint32 rotation)
 			charHeightLocal = charHeight;
 		}
 
-		/* Clear character cache */
-		for (i = 0; i < 256; i++) {
-			if (gfxPrimitivesFont[i]) {
-				SDL_DestroyTexture(gfxPrimitivesFont[i]);
-				gfxPrimitivesFont[i] = NULL;
-			}
-		}
+		/* Select atlas on next draw */
+		gfxPrimitivesCurrentAtlas = NULL;
 	}
 }
 
 /*!
-\brief Draw a character of the currently set font.
+\brief Internal function to build the glyph atlas texture of the current font and rotation.
 
-\param renderer The Renderer to draw on.
-\param x X (horizontal) coordinate of the upper left corner of the character.
-\param y Y (vertical) coordinate of the upper left corner of the character.
-\param c The character to draw.
-\param r The red value of the character to draw. 
-\param g The green value of the character to draw. 
-\param b The blue value of the character to draw. 
-\param a The alpha value of the character to draw.
+\param renderer The renderer the texture is created for.
 
-\returns Returns 0 on success, -1 on failure.
+\returns Returns the atlas texture or NULL on failure.
 */
-int characterRGBA(SDL_Renderer *renderer, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+static SDL_Texture *_gfxFontCreateAtlas(SDL_Renderer *renderer)
 {
-	SDL_Rect srect;
-	SDL_Rect drect;
-	int result;
-	Uint32 ix, iy;
+	SDL_Surface *atlas;
+	SDL_Texture *texture;
 	const unsigned char *charpos;
-	Uint8 *curpos;
+	Uint32 ci, ix, iy, ox, oy, dx, dy;
 	Uint8 patt, mask;
-	Uint8 *linepos;
-	Uint32 pitch;
-	SDL_Surface *character;
-	SDL_Surface *rotatedCharacter;
-	Uint32 ci;
-
-	/*
-	* Setup source rectangle
-	*/
-	srect.x = 0;
-	srect.y = 0;
-	srect.w = charWidthLocal;
-	srect.h = charHeightLocal;
 
 	/*
-	* Setup destination rectangle
+	* 16x16 glyphs in their rendered (rotated) size
 	*/
-	drect.x = x;
-	drect.y = y;
-	drect.w = charWidthLocal;
-	drect.h = charHeightLocal;
-
-	/* Character index in cache */
-	ci = (unsigned char) c;
+	atlas = SDL_CreateRGBSurface(SDL_SWSURFACE,
+		16 * charWidthLocal, 16 * charHeightLocal, 32,
+		0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
+	if (atlas == NULL) {
+		return (NULL);
+	}
+	if (SDL_MUSTLOCK(atlas)) {
+		assert(0);
+	}
 
 	/*
-	* Create new charWidth x charHeight bitmap surface if not already present.
-	* Might get rotated later.
+	* Drawing loop, rotating each glyph into its cell
 	*/
-	if (gfxPrimitivesFont[ci] == NULL) {
-		/*
-		* Redraw character into surface
-		*/
-		character =	SDL_CreateRGBSurface(SDL_SWSURFACE,
-			charWidth, charHeight, 32,
-			0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
-		if (SDL_MUSTLOCK(character)) {
-			assert(0);
-		}
-		if (character == NULL) {
-			return (-1);
-		}
-
+	for (ci = 0; ci < 256; ci++) {
 		charpos = currentFontdata + ci * charSize;
-				linepos = (Uint8 *)character->pixels;
-		pitch = character->pitch;
-
-		/*
-		* Drawing loop 
-		*/
+		ox = (ci & 15) * charWidthLocal;
+		oy = (ci >> 4) * charHeightLocal;
 		patt = 0;
 		for (iy = 0; iy < charHeight; iy++) {
 			mask = 0x00;
-			curpos = linepos;
 			for (ix = 0; ix < charWidth; ix++) {
 				if (!(mask >>= 1)) {
 					patt = *charpos++;
 					mask = 0x80;
 				}
-				if (patt & mask) {
-					*(Uint32 *)curpos = 0xffffffff;
-				} else {
-					*(Uint32 *)curpos = 0;
+				if (!(patt & mask)) {
+					continue;
+				}
+				switch (charRotation) {
+				case 1:
+					dx = charHeight - 1 - iy;
+					dy = ix;
+					break;
+				case 2:
+					dx = charWidth - 1 - ix;
+					dy = charHeight - 1 - iy;
+					break;
+				case 3:
+					dx = iy;
+					dy = charWidth - 1 - ix;
+					break;
+				default:
+					dx = ix;
+					dy = iy;
+					break;
 				}
-				curpos += 4;
+				*(Uint32 *)((Uint8 *)atlas->pixels + (oy + dy) * atlas->pitch + (ox + dx) * 4) = 0xffffffff;
 			}
-			linepos += pitch;
 		}
+	}
 
-		/* Maybe rotate and replace cached image */
-		if (charRotation>0)
-		{
-			rotatedCharacter = rotateSurface90Degrees(character, charRotation);
-			SDL_FreeSurface(character);
-			character = rotatedCharacter;
-		}
+	/* Convert temp surface into texture */
+	texture = SDL_CreateTextureFromSurface(renderer, atlas);
+	SDL_FreeSurface(atlas);
 
-		/* Convert temp surface into texture */
-		gfxPrimitivesFont[ci] = SDL_CreateTextureFromSurface(renderer, character);
-		SDL_FreeSurface(character);
+	return (texture);
+}
 
-		/*
-		* Check pointer 
-		*/
-		if (gfxPrimitivesFont[ci] == NULL) {
-			return (-1);
-		}
+/*!
+\brief Internal function to look up or create the glyph atlas of the current font.
+
+Atlases are cached per font data, size, rotation and renderer. When the cache is full 
+the least recently selected atlas is replaced.
+
+\param renderer The renderer to draw on.
+
+\returns Returns the atlas or NULL on failure.
+*/
+static SDL2_gfxFontAtlas *_gfxFontAtlas(SDL_Renderer *renderer)
+{
+	SDL2_gfxFontAtlas *atlas, *oldest;
+	int i;
+
+	atlas = gfxPrimitivesCurrentAtlas;
+	if ((atlas) && (atlas->renderer == renderer)) {
+		return (atlas);
 	}
 
-	/*
-	* Set color 
-	*/
-	result = 0;
-	result |= SDL_SetTextureColorMod(gfxPrimitivesFont[ci], r, g, b);
-	result |= SDL_SetTextureAlphaMod(gfxPrimitivesFont[ci], a);
+	oldest = &gfxPrimitivesFontAtlas[0];
+	for (i = 0; i < GFX_FONT_ATLAS_MAX; i++) {
+		atlas = &gfxPrimitivesFontAtlas[i];
+		if ((atlas->texture) && (atlas->renderer == renderer) && (atlas->fontdata == currentFontdata) &&
+			(atlas->width == charWidth) && (atlas->height == charHeight) && (atlas->rotation == charRotation)) {
+			atlas->age = ++gfxPrimitivesFontAge;
+			gfxPrimitivesCurrentAtlas = atlas;
+			return (atlas);
+		}
+		if ((oldest->texture) && ((atlas->texture == NULL) || (atlas->age < oldest->age))) {
+			oldest = atlas;
+		}
+	}
 
 	/*
-	* Draw texture onto destination 
+	* Not cached, replace a free or the least recently used entry 
 	*/
-	result |= SDL_RenderCopy(renderer, gfxPrimitivesFont[ci], &srect, &drect);
+	atlas = oldest;
+	if (atlas->texture) {
+		SDL_DestroyTexture(atlas->texture);
+	}
+	atlas->texture = _gfxFontCreateAtlas(renderer);
+	if (atlas->texture == NULL) {
+		return (NULL);
+	}
+	atlas->renderer = renderer;
+	atlas->fontdata = currentFontdata;
+	atlas->width = charWidth;
+	atlas->height = charHeight;
+	atlas->rotation = charRotation;
+	atlas->age = ++gfxPrimitivesFontAge;
+	gfxPrimitivesCurrentAtlas = atlas;
 
-	return (result);
+	return (atlas);
 }
 
-
 /*!
 \brief Draw a character of the currently set font.
 
-\param renderer The renderer to draw on.
+\param renderer The Renderer to draw on.
 \param x X (horizontal) coordinate of the upper left corner of the character.
 \param y Y (vertical) coordinate of the upper left corner of the character.
 \param c The character to draw.
-\param color The color value of the character to draw (0xRRGGBBAA). 
+\param r The red value of the character to draw. 
+\param g The green value of the character to draw. 
+\param b The blue value of the character to draw. 
+\param a The alpha value of the character to draw.
 
 \returns Returns 0 on success, -1 on failure.
 */
-int characterColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, char c, Uint32 color)
+int characterRGBA(SDL_Renderer *renderer, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
-	Uint8 *co = (Uint8 *)&color; 
-	return characterRGBA(renderer, x, y, c, co[0], co[1], co[2], co[3]);
-}
-
+	SDL2_gfxFontAtlas *atlas;
+	SDL_Rect srect;
+	SDL_Rect drect;
+	int result;
+	Uint32 ci;
+
+	atlas = _gfxFontAtlas(renderer);
+	if (atlas == NULL) {
+		return (-1);
+	}
+
+	/* Character index in atlas */
+	ci = (unsigned char) c;
+
+	/*
+	* Setup source rectangle
+	*/
+	srect.x = (ci & 15) * charWidthLocal;
+	srect.y = (ci >> 4) * charHeightLocal;
+	srect.w = charWidthLocal;
+	srect.h = charHeightLocal;
+
+	/*
+	* Setup destination rectangle
+	*/
+	drect.x = x;
+	drect.y = y;
+	drect.w = charWidthLocal;
+	drect.h = charHeightLocal;
+
+	/*
+	* Set color 
+	*/
+	result = 0;
+	result |= SDL_SetTextureColorMod(atlas->texture, r, g, b);
+	result |= SDL_SetTextureAlphaMod(atlas->texture, a);
+
+	/*
+	* Draw texture onto destination 
+	*/
+	result |= SDL_RenderCopy(renderer, atlas->texture, &srect, &drect);
+
+	return (result);
+}
+
+
+/*!
+\brief Draw a character of the currently set font.
+
+\param renderer The renderer to draw on.
+\param x X (horizontal) coordinate of the upper left corner of the character.
+\param y Y (vertical) coordinate of the upper left corner of the character.
+\param c The character to draw.
+\param color The color value of the character to draw (0xRRGGBBAA). 
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int characterColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, char c, Uint32 color)
+{
+	Uint8 *co = (Uint8 *)&color; 
+	return characterRGBA(renderer, x, y, c, co[0], co[1], co[2], co[3]);
+}
+
 
 /*!
 \brief Draw a string in the currently set font.
@@ -3780,6 +4158,9 @@ int stringColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint
 /*!
 \brief Draw a string in the currently set font.
 
+All characters are taken from the glyph atlas of the current font and submitted 
+as one geometry batch (per GFX_FONT_STRING_CHUNK characters).
+
 \param renderer The renderer to draw on.
 \param x X (horizontal) coordinate of the upper left corner of the string.
 \param y Y (vertical) coordinate of the upper left corner of the string.
@@ -3793,6 +4174,106 @@ int stringColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint
 */
 int stringRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL2_gfxFontAtlas *atlas;
+	SDL_Vertex vertices[GFX_FONT_STRING_CHUNK * 4];
+	int indices[GFX_FONT_STRING_CHUNK * 6];
+	SDL_Vertex *v;
+	SDL_Color color;
+	float u0, v0, du, dv;
+	int i, n, dx, dy;
+	Uint32 ci;
+	int result = 0;
+	float curx = x;
+	float cury = y;
+	const char *curchar = s;
+
+	atlas = _gfxFontAtlas(renderer);
+	if (atlas == NULL) {
+		return (-1);
+	}
+
+	/*
+	* Advance per character and texture cell size 
+	*/
+	dx = 0;
+	dy = 0;
+	switch (charRotation)
+	{
+	case 0:
+		dx = charWidthLocal;
+		break;
+	case 2:
+		dx = -(int)charWidthLocal;
+		break;
+	case 1:
+		dy = charHeightLocal;
+		break;
+	case 3:
+		dy = -(int)charHeightLocal;
+		break;
+	}
+	du = 1.0f / 16.0f;
+	dv = 1.0f / 16.0f;
+
+	color.r = r;
+	color.g = g;
+	color.b = b;
+	color.a = a;
+
+	for (i = 0; i < GFX_FONT_STRING_CHUNK; i++) {
+		indices[i * 6 + 0] = i * 4 + 0;
+		indices[i * 6 + 1] = i * 4 + 1;
+		indices[i * 6 + 2] = i * 4 + 2;
+		indices[i * 6 + 3] = i * 4 + 2;
+		indices[i * 6 + 4] = i * 4 + 3;
+		indices[i * 6 + 5] = i * 4 + 0;
+	}
+
+	while (*curchar && !result) {
+		/*
+		* Fill one chunk of quads 
+		*/
+		for (n = 0; (n < GFX_FONT_STRING_CHUNK) && (*curchar); n++) {
+			ci = (unsigned char) *curchar;
+			u0 = (ci & 15) * du;
+			v0 = (ci >> 4) * dv;
+
+			v = &vertices[n * 4];
+			v[0].position.x = curx;
+			v[0].position.y = cury;
+			v[0].tex_coord.x = u0;
+			v[0].tex_coord.y = v0;
+			v[1].position.x = curx + charWidthLocal;
+			v[1].position.y = cury;
+			v[1].tex_coord.x = u0 + du;
+			v[1].tex_coord.y = v0;
+			v[2].position.x = curx + charWidthLocal;
+			v[2].position.y = cury + charHeightLocal;
+			v[2].tex_coord.x = u0 + du;
+			v[2].tex_coord.y = v0 + dv;
+			v[3].position.x = curx;
+			v[3].position.y = cury + charHeightLocal;
+			v[3].tex_coord.x = u0;
+			v[3].tex_coord.y = v0 + dv;
+			v[0].color = color;
+			v[1].color = color;
+			v[2].color = color;
+			v[3].color = color;
+
+			curx += dx;
+			cury += dy;
+			curchar++;
+		}
+
+		/*
+		* Draw chunk in one call 
+		*/
+		result |= SDL_RenderGeometry(renderer, atlas->texture, vertices, n * 4, indices, n * 6);
+	}
+
+	return (result);
+#else
 	int result = 0;
 	Sint16 curx = x;
 	Sint16 cury = y;
@@ -3819,6 +4300,7 @@ int stringRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint8
 	}
 
 	return (result);
+#endif
 }
 
 int primitivePurge(void) {
@@ -4502,7 +4984,7 @@ int thickLineRGBA(SDL_Renderer *renderer, Sint16 x1, Sint16 y1, Sint16 x2, Sint1
 	int wh;
 	SDL2_gfxMurphyIterator m;
 
-	if (renderer == NULL) {
+	if ((renderer == NULL) && (gfxPrimitivesBatch == NULL)) {
 		return -1;
 	}
 	if (width < 1) {
@@ -4519,8 +5001,7 @@ int thickLineRGBA(SDL_Renderer *renderer, Sint16 x1, Sint16 y1, Sint16 x2, Sint1
 	* Set color
 	*/
 	result = 0;
-	result |= SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
-	result |= SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	result |= _gfxSetDrawColor(renderer, r, g, b, a);
 
 	/* 
 	* Draw
@@ -4531,3 +5012,403 @@ int thickLineRGBA(SDL_Renderer *renderer, Sint16 x1, Sint16 y1, Sint16 x2, Sint1
 
 	return(0);
 }
+
+/* ---- Batched primitives */
+
+/*!
+\brief Create a batch that submits to a renderer.
+
+The batch functions collect points and spans grouped by color/alpha instead of
+drawing them one by one. gfxBatchFlush() then submits each group with a single
+SDL_RenderDrawPoints/SDL_RenderFillRects call. Note that the drawing order
+between different colors is not preserved.
+
+\param renderer The renderer to draw on.
+
+\returns Returns the new batch or NULL on failure.
+*/
+SDL2_gfxBatch *gfxBatchCreate(SDL_Renderer * renderer)
+{
+	SDL2_gfxBatch *batch;
+
+	if (renderer == NULL) {
+		return (NULL);
+	}
+
+	batch = (SDL2_gfxBatch *) calloc(1, sizeof(SDL2_gfxBatch));
+	if (batch == NULL) {
+		return (NULL);
+	}
+
+	batch->renderer = renderer;
+	batch->last = -1;
+
+	return (batch);
+}
+
+/*!
+\brief Create a batch that renders into a ARGB8888 buffer (no renderer required).
+
+\param pixels The ARGB8888 pixel buffer to draw on.
+\param w The width of the buffer in pixels.
+\param h The height of the buffer in pixels.
+\param pitch The length of a buffer row in bytes.
+
+\returns Returns the new batch or NULL on failure.
+*/
+SDL2_gfxBatch *gfxBatchCreateBuffer(Uint32 * pixels, int w, int h, int pitch)
+{
+	SDL2_gfxBatch *batch;
+
+	if ((pixels == NULL) || (w <= 0) || (h <= 0) || (pitch < w * 4)) {
+		return (NULL);
+	}
+
+	batch = (SDL2_gfxBatch *) calloc(1, sizeof(SDL2_gfxBatch));
+	if (batch == NULL) {
+		return (NULL);
+	}
+
+	batch->pixels = pixels;
+	batch->width = w;
+	batch->height = h;
+	batch->pitch = pitch;
+	batch->last = -1;
+
+	return (batch);
+}
+
+/*!
+\brief Destroy a batch and free all its memory; pending output is discarded.
+
+\param batch The batch to destroy.
+*/
+void gfxBatchDestroy(SDL2_gfxBatch * batch)
+{
+	int i;
+
+	if (batch == NULL) {
+		return;
+	}
+
+	for (i = 0; i < batch->numBuckets; i++) {
+		free(batch->buckets[i].points);
+		free(batch->buckets[i].rects);
+	}
+
+	free(batch->buckets);
+	free(batch->slots);
+	free(batch);
+}
+
+/*!
+\brief Internal function to blend one pixel into a ARGB8888 buffer.
+
+\param dst Pointer to the destination pixel.
+\param key The color value (0xRRGGBBAA).
+*/
+static void _gfxBatchBlendPixel(Uint32 *dst, Uint32 key)
+{
+	Uint32 a = key & 0xff;
+	Uint32 ia = 255 - a;
+	Uint32 d = *dst;
+	Uint32 r, g, b;
+
+	if (a == 255) {
+		*dst = 0xff000000 | (key >> 8);
+		return;
+	}
+
+	r = ((key >> 24) * a + ((d >> 16) & 0xff) * ia) / 255;
+	g = (((key >> 16) & 0xff) * a + ((d >> 8) & 0xff) * ia) / 255;
+	b = (((key >> 8) & 0xff) * a + (d & 0xff) * ia) / 255;
+
+	*dst = (d & 0xff000000) | (r << 16) | (g << 8) | b;
+}
+
+/*!
+\brief Internal function to render a batch bucket into the ARGB8888 buffer.
+
+\param batch The batch.
+\param bucket The bucket to render.
+*/
+static void _gfxBatchFlushBuffer(SDL2_gfxBatch *batch, SDL2_gfxBatchBucket *bucket)
+{
+	int i, x, y, x1, y1, x2, y2;
+	Uint32 *row;
+	SDL_Point *p;
+	SDL_Rect *rect;
+	Uint32 argb = 0xff000000 | (bucket->key >> 8);
+
+	for (i = 0; i < bucket->numPoints; i++) {
+		p = &bucket->points[i];
+		if ((p->x < 0) || (p->y < 0) || (p->x >= batch->width) || (p->y >= batch->height)) {
+			continue;
+		}
+		row = (Uint32 *)((Uint8 *)batch->pixels + p->y * batch->pitch);
+		_gfxBatchBlendPixel(&row[p->x], bucket->key);
+	}
+
+	for (i = 0; i < bucket->numRects; i++) {
+		rect = &bucket->rects[i];
+		x1 = (rect->x < 0) ? 0 : rect->x;
+		y1 = (rect->y < 0) ? 0 : rect->y;
+		x2 = rect->x + rect->w;
+		y2 = rect->y + rect->h;
+		if (x2 > batch->width) {
+			x2 = batch->width;
+		}
+		if (y2 > batch->height) {
+			y2 = batch->height;
+		}
+
+		for (y = y1; y < y2; y++) {
+			row = (Uint32 *)((Uint8 *)batch->pixels + y * batch->pitch);
+			if ((bucket->key & 0xff) == 255) {
+				for (x = x1; x < x2; x++) {
+					row[x] = argb;
+				}
+			} else {
+				for (x = x1; x < x2; x++) {
+					_gfxBatchBlendPixel(&row[x], bucket->key);
+				}
+			}
+		}
+	}
+}
+
+/*!
+\brief Submit all collected points and spans, one draw call per color and type.
+
+The batch is empty afterwards but keeps its memory for the next frame.
+
+\param batch The batch to flush.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int gfxBatchFlush(SDL2_gfxBatch * batch)
+{
+	int i;
+	int result;
+	Uint8 a;
+	SDL2_gfxBatchBucket *bucket;
+
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	result = 0;
+	for (i = 0; i < batch->numBuckets; i++) {
+		bucket = &batch->buckets[i];
+		if ((bucket->numPoints == 0) && (bucket->numRects == 0)) {
+			continue;
+		}
+
+		if (batch->pixels != NULL) {
+			_gfxBatchFlushBuffer(batch, bucket);
+		} else {
+			a = bucket->key & 0xff;
+			result |= SDL_SetRenderDrawBlendMode(batch->renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+			result |= SDL_SetRenderDrawColor(batch->renderer, bucket->key >> 24, (bucket->key >> 16) & 0xff, (bucket->key >> 8) & 0xff, a);
+			if (bucket->numPoints > 0) {
+				result |= SDL_RenderDrawPoints(batch->renderer, bucket->points, bucket->numPoints);
+			}
+			if (bucket->numRects > 0) {
+				result |= SDL_RenderFillRects(batch->renderer, bucket->rects, bucket->numRects);
+			}
+		}
+
+		bucket->numPoints = 0;
+		bucket->numRects = 0;
+	}
+
+	return (result);
+}
+
+/*!
+\brief Add a pixel to a batch.
+
+\param batch The batch to draw on.
+\param x X (horizontal) coordinate of the pixel.
+\param y Y (vertical) coordinate of the pixel.
+\param r The red color value of the pixel to draw. 
+\param g The green color value of the pixel to draw.
+\param b The blue color value of the pixel to draw.
+\param a The alpha value of the pixel to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int pixelRGBABatch(SDL2_gfxBatch * batch, Sint16 x, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	return (_gfxBatchPoint(batch, x, y, r, g, b, a));
+}
+
+/*!
+\brief Add a horizontal line to a batch.
+
+\param batch The batch to draw on.
+\param x1 X coordinate of the first point (i.e. left) of the line.
+\param x2 X coordinate of the second point (i.e. right) of the line.
+\param y Y coordinate of the points of the line.
+\param r The red value of the line to draw. 
+\param g The green value of the line to draw. 
+\param b The blue value of the line to draw. 
+\param a The alpha value of the line to draw. 
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int hlineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 x2, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	return (_gfxBatchRect(batch, x1, y, x2, y, r, g, b, a));
+}
+
+/*!
+\brief Add a line to a batch.
+
+\param batch The batch to draw on.
+\param x1 X coordinate of the first point of the line.
+\param y1 Y coordinate of the first point of the line.
+\param x2 X coordinate of the second point of the line.
+\param y2 Y coordinate of the second point of the line.
+\param r The red value of the line to draw. 
+\param g The green value of the line to draw. 
+\param b The blue value of the line to draw. 
+\param a The alpha value of the line to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int lineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	return (_gfxBatchLine(batch, x1, y1, x2, y2, r, g, b, a));
+}
+
+/*!
+\brief Add an anti-aliased line to a batch.
+
+\param batch The batch to draw on.
+\param x1 X coordinate of the first point of the aa-line.
+\param y1 Y coordinate of the first point of the aa-line.
+\param x2 X coordinate of the second point of the aa-line.
+\param y2 Y coordinate of the second point of the aa-line.
+\param r The red value of the aa-line to draw. 
+\param g The green value of the aa-line to draw. 
+\param b The blue value of the aa-line to draw. 
+\param a The alpha value of the aa-line to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int aalineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result;
+
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	gfxPrimitivesBatch = batch;
+	result = _aalineRGBA(batch->renderer, x1, y1, x2, y2, r, g, b, a, 1);
+	gfxPrimitivesBatch = NULL;
+
+	return (result);
+}
+
+/*!
+\brief Add an anti-aliased circle to a batch.
+
+\param batch The batch to draw on.
+\param x X coordinate of the center of the aa-circle.
+\param y Y coordinate of the center of the aa-circle.
+\param rad Radius in pixels of the aa-circle.
+\param r The red value of the aa-circle to draw. 
+\param g The green value of the aa-circle to draw. 
+\param b The blue value of the aa-circle to draw. 
+\param a The alpha value of the aa-circle to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int aacircleRGBABatch(SDL2_gfxBatch * batch, Sint16 x, Sint16 y, Sint16 rad, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result;
+
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	gfxPrimitivesBatch = batch;
+	result = aaellipseRGBA(batch->renderer, x, y, rad, rad, r, g, b, a);
+	gfxPrimitivesBatch = NULL;
+
+	return (result);
+}
+
+/*!
+\brief Add a filled polygon to a batch.
+
+\param batch The batch to draw on.
+\param vx Vertex array containing X coordinates of the points of the filled polygon.
+\param vy Vertex array containing Y coordinates of the points of the filled polygon.
+\param n Number of points in the vertex array. Minimum number is 3.
+\param r The red value of the filled polygon to draw. 
+\param g The green value of the filled polygon to draw. 
+\param b The blue value of the filed polygon to draw. 
+\param a The alpha value of the filled polygon to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int filledPolygonRGBABatch(SDL2_gfxBatch * batch, const Sint16 * vx, const Sint16 * vy, int n, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result;
+
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	gfxPrimitivesBatch = batch;
+	result = filledPolygonRGBAMT(batch->renderer, vx, vy, n, r, g, b, a, NULL, NULL);
+	gfxPrimitivesBatch = NULL;
+
+	return (result);
+}
+
+/*!
+\brief Add a thick line to a batch.
+
+\param batch The batch to draw on.
+\param x1 X coordinate of the first point of the line.
+\param y1 Y coordinate of the first point of the line.
+\param x2 X coordinate of the second point of the line.
+\param y2 Y coordinate of the second point of the line.
+\param width Width of the line in pixels. Must be >0.
+\param r The red value of the line to draw. 
+\param g The green value of the line to draw. 
+\param b The blue value of the line to draw. 
+\param a The alpha value of the line to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int thickLineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, Uint8 width, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result;
+
+	if (batch == NULL) {
+		return (-1);
+	}
+
+	gfxPrimitivesBatch = batch;
+	result = thickLineRGBA(batch->renderer, x1, y1, x2, y2, width, r, g, b, a);
+	gfxPrimitivesBatch = NULL;
+
+	return (result);
+}
@@ -238,6 +238,28 @@ extern "C" {
 
 	SDL2_GFXPRIMITIVES_SCOPE int primitivePurge(void);
 
+	/* Batching */
+
+	typedef struct SDL2_gfxBatch SDL2_gfxBatch;
+
+	SDL2_GFXPRIMITIVES_SCOPE SDL2_gfxBatch * gfxBatchCreate(SDL_Renderer * renderer);
+	SDL2_GFXPRIMITIVES_SCOPE SDL2_gfxBatch * gfxBatchCreateBuffer(Uint32 * pixels, int w, int h, int pitch);
+	SDL2_GFXPRIMITIVES_SCOPE void gfxBatchDestroy(SDL2_gfxBatch * batch);
+	SDL2_GFXPRIMITIVES_SCOPE int gfxBatchFlush(SDL2_gfxBatch * batch);
+
+	SDL2_GFXPRIMITIVES_SCOPE int pixelRGBABatch(SDL2_gfxBatch * batch, Sint16 x, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int hlineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 x2, Sint16 y, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int lineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 y1,
+		Sint16 x2, Sint16 y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int aalineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 y1,
+		Sint16 x2, Sint16 y2, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int aacircleRGBABatch(SDL2_gfxBatch * batch, Sint16 x, Sint16 y,
+		Sint16 rad, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int filledPolygonRGBABatch(SDL2_gfxBatch * batch, const Sint16 * vx,
+		const Sint16 * vy, int n, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int thickLineRGBABatch(SDL2_gfxBatch * batch, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, 
+		Uint8 width, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+
 	/* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
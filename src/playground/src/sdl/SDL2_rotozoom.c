@@ -36,6 +36,14 @@ Andreas Schiffler -- aschiffler at ferzkopp dot net
 
 #include "SDL2_rotozoom.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ROTOZOOM_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ROTOZOOM_NEON
+#endif
+
 /* ---- Internally used structures */
 
 /*!
@@ -259,12 +267,358 @@ int _shrinkSurfaceY(SDL_Surface * src, SDL_Surface * dst, int factorx, int facto
 	return (0);
 }
 
+/*!
+\brief Maximum number of threads used by the 32 bit zoomer and rotozoomer.
+*/
+#define ROTOZOOM_MAX_THREADS 8
+
+/*!
+\brief Minimum number of destination rows per thread.
+*/
+#define ROTOZOOM_MIN_BAND_ROWS 32
+
+/*!
+\brief Number of pixels interpolated per batch by the bilinear kernel.
+*/
+#define ROTOZOOM_CHUNK 64
+
+/*!
+\brief A band of destination rows processed by one thread.
+*/
+typedef struct tRotozoomBand {
+	void (*func)(void *data, int y0, int y1);
+	void *data;
+	int y0;
+	int y1;
+} tRotozoomBand;
+
+/*!
+\brief Row band worker pool; the calling thread always processes the first band.
+*/
+static int rotozoomThreadCount = 0;
+static int rotozoomWorkerCount = 0;
+static volatile int rotozoomQuit = 0;
+static SDL_Thread *rotozoomWorkers[ROTOZOOM_MAX_THREADS];
+static SDL_sem *rotozoomStart[ROTOZOOM_MAX_THREADS];
+static SDL_sem *rotozoomDone = NULL;
+static tRotozoomBand rotozoomBands[ROTOZOOM_MAX_THREADS];
+
+/*!
+\brief Internal worker thread function, processes one band per start signal.
+
+\param data Index of the worker (as pointer).
+
+\return Always 0.
+*/
+static int _rotozoomWorker(void *data)
+{
+	int i = (int)(size_t)data;
+	tRotozoomBand *band = &rotozoomBands[i];
+
+	while (1) {
+		SDL_SemWait(rotozoomStart[i]);
+		if (rotozoomQuit) {
+			break;
+		}
+		band->func(band->data, band->y0, band->y1);
+		SDL_SemPost(rotozoomDone);
+	}
+
+	return (0);
+}
+
+/*!
+\brief Internal function to stop all worker threads.
+*/
+static void _rotozoomStopWorkers(void)
+{
+	int i;
+
+	if (rotozoomWorkerCount == 0) {
+		return;
+	}
+
+	rotozoomQuit = 1;
+	for (i = 1; i <= rotozoomWorkerCount; i++) {
+		SDL_SemPost(rotozoomStart[i]);
+		SDL_WaitThread(rotozoomWorkers[i], NULL);
+		SDL_DestroySemaphore(rotozoomStart[i]);
+	}
+	SDL_DestroySemaphore(rotozoomDone);
+	rotozoomDone = NULL;
+	rotozoomWorkerCount = 0;
+	rotozoomQuit = 0;
+}
+
+/*!
+\brief Internal function to start the worker threads (band 0 is done by the caller).
+
+\param count Number of worker threads to start.
+
+\return Number of running worker threads.
+*/
+static int _rotozoomStartWorkers(int count)
+{
+	if (rotozoomDone == NULL) {
+		rotozoomDone = SDL_CreateSemaphore(0);
+		if (rotozoomDone == NULL) {
+			return (0);
+		}
+	}
+
+	while (rotozoomWorkerCount < count) {
+		int i = rotozoomWorkerCount + 1;
+		rotozoomStart[i] = SDL_CreateSemaphore(0);
+		if (rotozoomStart[i] == NULL) {
+			break;
+		}
+		rotozoomWorkers[i] = SDL_CreateThread(_rotozoomWorker, "rotozoom", (void *)(size_t)i);
+		if (rotozoomWorkers[i] == NULL) {
+			SDL_DestroySemaphore(rotozoomStart[i]);
+			break;
+		}
+		rotozoomWorkerCount++;
+	}
+
+	return (rotozoomWorkerCount);
+}
+
+/*!
+\brief Internal function to split the destination rows into bands and process them in parallel.
+
+\param func The band function.
+\param data The data passed to the band function.
+\param h The number of destination rows.
+*/
+static void _rotozoomRunBands(void (*func)(void *data, int y0, int y1), void *data, int h)
+{
+	int i, bands, y;
+
+	if (rotozoomThreadCount == 0) {
+		rotozoomSetThreads(0);
+	}
+
+	bands = h / ROTOZOOM_MIN_BAND_ROWS;
+	if (bands > rotozoomThreadCount) {
+		bands = rotozoomThreadCount;
+	}
+	if (bands > 1) {
+		bands = _rotozoomStartWorkers(bands - 1) + 1;
+	}
+	if (bands <= 1) {
+		func(data, 0, h);
+		return;
+	}
+
+	y = 0;
+	for (i = 0; i < bands; i++) {
+		rotozoomBands[i].func = func;
+		rotozoomBands[i].data = data;
+		rotozoomBands[i].y0 = y;
+		y = (h * (i + 1)) / bands;
+		rotozoomBands[i].y1 = y;
+	}
+
+	for (i = 1; i < bands; i++) {
+		SDL_SemPost(rotozoomStart[i]);
+	}
+
+	func(data, rotozoomBands[0].y0, rotozoomBands[0].y1);
+
+	for (i = 1; i < bands; i++) {
+		SDL_SemWait(rotozoomDone);
+	}
+}
+
+/*!
+\brief Set the number of threads used by the 32 bit zoomer and rotozoomer.
+
+The destination surface is split into row bands which are processed in parallel.
+The functions are not reentrant when more than one thread is used.
+
+\param threads Number of threads; 0 selects the number of CPU cores, 1 disables threading.
+*/
+void rotozoomSetThreads(int threads)
+{
+	if (threads <= 0) {
+		threads = SDL_GetCPUCount();
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+	if (threads > ROTOZOOM_MAX_THREADS) {
+		threads = ROTOZOOM_MAX_THREADS;
+	}
+
+	if (threads - 1 < rotozoomWorkerCount) {
+		_rotozoomStopWorkers();
+	}
+
+	rotozoomThreadCount = threads;
+}
+
+/*!
+\brief Internal bilinear interpolation of 32 bit pixels.
+
+Interpolates n pixels from their four neighbours c00 (top left), c01 (top right),
+c10 (bottom left) and c11 (bottom right) with 8 bit weights fx and fy.
+Uses SSE2 or NEON for two pixels per step if available.
+
+\param dp Destination pixels.
+\param n Number of pixels.
+\param c00 Top left source pixels.
+\param c01 Top right source pixels.
+\param c10 Bottom left source pixels.
+\param c11 Bottom right source pixels.
+\param fx Horizontal weights (0..255).
+\param fy Vertical weights (0..255).
+*/
+static void _interpolateRGBA(Uint32 *dp, int n, const Uint32 *c00, const Uint32 *c01, const Uint32 *c10, const Uint32 *c11, const Uint16 *fx, const Uint16 *fy)
+{
+	int i = 0;
+	Uint32 t1, t2, rb, ag, wx, wy;
+
+#if defined(ROTOZOOM_SSE2)
+	__m128i zero = _mm_setzero_si128();
+	__m128i k256 = _mm_set1_epi16(256);
+	__m128i a, b, d, e, vx, vy, top, bottom;
+
+	for (; i + 1 < n; i += 2) {
+		a = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)c00[i]), _mm_cvtsi32_si128((int)c00[i+1])), zero);
+		b = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)c01[i]), _mm_cvtsi32_si128((int)c01[i+1])), zero);
+		d = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)c10[i]), _mm_cvtsi32_si128((int)c10[i+1])), zero);
+		e = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)c11[i]), _mm_cvtsi32_si128((int)c11[i+1])), zero);
+		vx = _mm_unpacklo_epi64(_mm_set1_epi16((short)fx[i]), _mm_set1_epi16((short)fx[i+1]));
+		vy = _mm_unpacklo_epi64(_mm_set1_epi16((short)fy[i]), _mm_set1_epi16((short)fy[i+1]));
+
+		top = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, _mm_sub_epi16(k256, vx)), _mm_mullo_epi16(b, vx)), 8);
+		bottom = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(k256, vx)), _mm_mullo_epi16(e, vx)), 8);
+		a = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(top, _mm_sub_epi16(k256, vy)), _mm_mullo_epi16(bottom, vy)), 8);
+
+		_mm_storel_epi64((__m128i *)&dp[i], _mm_packus_epi16(a, a));
+	}
+#elif defined(ROTOZOOM_NEON)
+	uint16x8_t k256 = vdupq_n_u16(256);
+	uint16x8_t a, b, d, e, vx, vy, top, bottom;
+
+	for (; i + 1 < n; i += 2) {
+		a = vmovl_u8(vcreate_u8((Uint64)c00[i] | ((Uint64)c00[i+1] << 32)));
+		b = vmovl_u8(vcreate_u8((Uint64)c01[i] | ((Uint64)c01[i+1] << 32)));
+		d = vmovl_u8(vcreate_u8((Uint64)c10[i] | ((Uint64)c10[i+1] << 32)));
+		e = vmovl_u8(vcreate_u8((Uint64)c11[i] | ((Uint64)c11[i+1] << 32)));
+		vx = vcombine_u16(vdup_n_u16(fx[i]), vdup_n_u16(fx[i+1]));
+		vy = vcombine_u16(vdup_n_u16(fy[i]), vdup_n_u16(fy[i+1]));
+
+		top = vshrq_n_u16(vmlaq_u16(vmulq_u16(a, vsubq_u16(k256, vx)), b, vx), 8);
+		bottom = vshrq_n_u16(vmlaq_u16(vmulq_u16(d, vsubq_u16(k256, vx)), e, vx), 8);
+		a = vshrq_n_u16(vmlaq_u16(vmulq_u16(top, vsubq_u16(k256, vy)), bottom, vy), 8);
+
+		vst1_u8((uint8_t *)&dp[i], vmovn_u16(a));
+	}
+#endif
+
+	/*
+	* Remaining pixels (or all without SIMD support)
+	*/
+	for (; i < n; i++) {
+		/* Two channels at once, each in its own 16 bit lane */
+		wx = fx[i];
+		wy = fy[i];
+		t1 = ((((c00[i] & 0x00ff00ff) * (256 - wx)) + ((c01[i] & 0x00ff00ff) * wx)) >> 8) & 0x00ff00ff;
+		t2 = ((((c10[i] & 0x00ff00ff) * (256 - wx)) + ((c11[i] & 0x00ff00ff) * wx)) >> 8) & 0x00ff00ff;
+		rb = (((t1 * (256 - wy)) + (t2 * wy)) >> 8) & 0x00ff00ff;
+		t1 = ((((c00[i] >> 8) & 0x00ff00ff) * (256 - wx)) + (((c01[i] >> 8) & 0x00ff00ff) * wx)) & 0xff00ff00;
+		t2 = ((((c10[i] >> 8) & 0x00ff00ff) * (256 - wx)) + (((c11[i] >> 8) & 0x00ff00ff) * wx)) & 0xff00ff00;
+		ag = (((t1 >> 8) * (256 - wy)) + ((t2 >> 8) * wy)) & 0xff00ff00;
+		dp[i] = rb | ag;
+	}
+}
+
+/*!
+\brief Context of the 32 bit zoomer shared by all row bands.
+*/
+typedef struct tZoomRGBA {
+	SDL_Surface *src;
+	SDL_Surface *dst;
+	int *sax;
+	int *say;
+	int flipx;
+	int flipy;
+	int smooth;
+} tZoomRGBA;
+
+/*!
+\brief Internal 32 bit zoomer for a band of destination rows.
+
+\param data The zoom context (tZoomRGBA).
+\param y0 First destination row.
+\param y1 Destination row after the last one.
+*/
+static void _zoomBandRGBA(void *data, int y0, int y1)
+{
+	tZoomRGBA *z = (tZoomRGBA *)data;
+	int x, y, i, n, cx, cy, ox, step, spixelw, spixelh, spixelgap;
+	Uint32 *row0, *row1, *dp;
+	Uint32 c00[ROTOZOOM_CHUNK], c01[ROTOZOOM_CHUNK], c10[ROTOZOOM_CHUNK], c11[ROTOZOOM_CHUNK];
+	Uint16 fx[ROTOZOOM_CHUNK], fy[ROTOZOOM_CHUNK];
+
+	spixelw = (z->src->w - 1);
+	spixelh = (z->src->h - 1);
+	spixelgap = z->src->pitch/4;
+
+	for (y = y0; y < y1; y++) {
+		cy = (z->say[y] >> 16);
+		row0 = (Uint32 *) z->src->pixels + (z->flipy ? spixelh - cy : cy) * spixelgap;
+		row1 = row0;
+		if (cy < spixelh) {
+			row1 = z->flipy ? row0 - spixelgap : row0 + spixelgap;
+		}
+		dp = (Uint32 *) ((Uint8 *) z->dst->pixels + y * z->dst->pitch);
+
+		if (!z->smooth) {
+			/*
+			* Non-Interpolating Zoom 
+			*/
+			for (x = 0; x < z->dst->w; x++) {
+				cx = (z->sax[x] >> 16);
+				dp[x] = row0[z->flipx ? spixelw - cx : cx];
+			}
+			continue;
+		}
+
+		/*
+		* Interpolating Zoom, gathered in chunks for the interpolation kernel
+		*/
+		for (i = 0; i < ROTOZOOM_CHUNK; i++) {
+			fy[i] = (Uint16) ((z->say[y] & 0xffff) >> 8);
+		}
+		for (x = 0; x < z->dst->w; x += n) {
+			n = z->dst->w - x;
+			if (n > ROTOZOOM_CHUNK) {
+				n = ROTOZOOM_CHUNK;
+			}
+			for (i = 0; i < n; i++) {
+				cx = (z->sax[x + i] >> 16);
+				ox = z->flipx ? spixelw - cx : cx;
+				step = (cx < spixelw) ? (z->flipx ? -1 : 1) : 0;
+				c00[i] = row0[ox];
+				c01[i] = row0[ox + step];
+				c10[i] = row1[ox];
+				c11[i] = row1[ox + step];
+				fx[i] = (Uint16) ((z->sax[x + i] & 0xffff) >> 8);
+			}
+			_interpolateRGBA(dp + x, n, c00, c01, c10, c11, fx, fy);
+		}
+	}
+}
+
 /*! 
 \brief Internal 32 bit Zoomer with optional anti-aliasing by bilinear interpolation.
 
 Zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface.
 Assumes src and dst surfaces are of 32 bit depth.
 Assumes dst surface was allocated with the correct dimensions.
+The destination rows are split into bands processed in parallel (see rotozoomSetThreads).
 
 \param src The surface to zoom (input).
 \param dst The zoomed surface (output).
@@ -276,10 +630,9 @@ Assumes dst surface was allocated with the correct dimensions.
 */
 int _zoomSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int smooth)
 {
-	int x, y, sx, sy, ssx, ssy, *sax, *say, *csax, *csay, *salast, csx, csy, ex, ey, cx, cy, sstep, sstepx, sstepy;
-	tColorRGBA *c00, *c01, *c10, *c11;
-	tColorRGBA *sp, *csp, *dp;
-	int spixelgap, spixelw, spixelh, dgap, t1, t2;
+	int x, y, sx, sy, ssx, ssy, *sax, *say, *csax, *csay, csx, csy;
+	int spixelw, spixelh;
+	tZoomRGBA z;
 
 	/*
 	* Allocate memory for row/column increments 
@@ -337,151 +690,17 @@ int _zoomSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy,
 		}
 	}
 
-	sp = (tColorRGBA *) src->pixels;
-	dp = (tColorRGBA *) dst->pixels;
-	dgap = dst->pitch - dst->w * 4;
-	spixelgap = src->pitch/4;
-
-	if (flipx) sp += spixelw;
-	if (flipy) sp += (spixelgap * spixelh);
-
 	/*
-	* Switch between interpolating and non-interpolating code 
+	* Zoom the row bands 
 	*/
-	if (smooth) {
-
-		/*
-		* Interpolating Zoom 
-		*/
-		csay = say;
-		for (y = 0; y < dst->h; y++) {
-			csp = sp;
-			csax = sax;
-			for (x = 0; x < dst->w; x++) {
-				/*
-				* Setup color source pointers 
-				*/
-				ex = (*csax & 0xffff);
-				ey = (*csay & 0xffff);
-				cx = (*csax >> 16);
-				cy = (*csay >> 16);
-				sstepx = cx < spixelw;
-				sstepy = cy < spixelh;
-				c00 = sp;
-				c01 = sp;
-				c10 = sp;
-				if (sstepy) {
-					if (flipy) {
-						c10 -= spixelgap;
-					} else {
-						c10 += spixelgap;
-					}
-				}
-				c11 = c10;
-				if (sstepx) {
-					if (flipx) {
-						c01--;
-						c11--;
-					} else {
-						c01++;
-						c11++;
-					}
-				}
-
-				/*
-				* Draw and interpolate colors 
-				*/
-				t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
-				t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
-				dp->r = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
-				t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
-				dp->g = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
-				t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
-				dp->b = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
-				t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
-				dp->a = (((t2 - t1) * ey) >> 16) + t1;				
-				/*
-				* Advance source pointer x
-				*/
-				salast = csax;
-				csax++;				
-				sstep = (*csax >> 16) - (*salast >> 16);
-				if (flipx) {
-					sp -= sstep;
-				} else {
-					sp += sstep;
-				}
-
-				/*
-				* Advance destination pointer x
-				*/
-				dp++;
-			}
-			/*
-			* Advance source pointer y
-			*/
-			salast = csay;
-			csay++;
-			sstep = (*csay >> 16) - (*salast >> 16);
-			sstep *= spixelgap;
-			if (flipy) { 
-				sp = csp - sstep;
-			} else {
-				sp = csp + sstep;
-			}
-
-			/*
-			* Advance destination pointer y
-			*/
-			dp = (tColorRGBA *) ((Uint8 *) dp + dgap);
-		}
-	} else {
-		/*
-		* Non-Interpolating Zoom 
-		*/		
-		csay = say;
-		for (y = 0; y < dst->h; y++) {
-			csp = sp;
-			csax = sax;
-			for (x = 0; x < dst->w; x++) {
-				/*
-				* Draw 
-				*/
-				*dp = *sp;
-
-				/*
-				* Advance source pointer x
-				*/
-				salast = csax;
-				csax++;				
-				sstep = (*csax >> 16) - (*salast >> 16);
-				if (flipx) sstep = -sstep;
-				sp += sstep;
-
-				/*
-				* Advance destination pointer x
-				*/
-				dp++;
-			}
-			/*
-			* Advance source pointer y
-			*/
-			salast = csay;
-			csay++;
-			sstep = (*csay >> 16) - (*salast >> 16);
-			sstep *= spixelgap;
-			if (flipy) sstep = -sstep;			
-			sp = csp + sstep;
-
-			/*
-			* Advance destination pointer y
-			*/
-			dp = (tColorRGBA *) ((Uint8 *) dp + dgap);
-		}
-	}
+	z.src = src;
+	z.dst = dst;
+	z.sax = sax;
+	z.say = say;
+	z.flipx = flipx;
+	z.flipy = flipy;
+	z.smooth = smooth;
+	_rotozoomRunBands(_zoomBandRGBA, &z, dst->h);
 
 	/*
 	* Remove temp arrays 
@@ -607,124 +826,147 @@ int _zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy)
 	return (0);
 }
 
-/*! 
-\brief Internal 32 bit rotozoomer with optional anti-aliasing.
+/*!
+\brief Context of the 32 bit rotozoomer shared by all row bands.
+*/
+typedef struct tTransformRGBA {
+	SDL_Surface *src;
+	SDL_Surface *dst;
+	int cx;
+	int cy;
+	int isin;
+	int icos;
+	int flipx;
+	int flipy;
+	int smooth;
+} tTransformRGBA;
 
-Rotates and zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface based on the control 
-parameters by scanning the destination surface and applying optionally anti-aliasing
-by bilinear interpolation.
-Assumes src and dst surfaces are of 32 bit depth.
-Assumes dst surface was allocated with the correct dimensions.
+/*!
+\brief Internal 32 bit rotozoomer for a band of destination rows.
 
-\param src Source surface.
-\param dst Destination surface.
-\param cx Horizontal center coordinate.
-\param cy Vertical center coordinate.
-\param isin Integer version of sine of angle.
-\param icos Integer version of cosine of angle.
-\param flipx Flag indicating horizontal mirroring should be applied.
-\param flipy Flag indicating vertical mirroring should be applied.
-\param smooth Flag indicating anti-aliasing should be used.
+\param data The transform context (tTransformRGBA).
+\param y0 First destination row.
+\param y1 Destination row after the last one.
 */
-void _transformSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int isin, int icos, int flipx, int flipy, int smooth)
+static void _transformBandRGBA(void *data, int y0, int y1)
 {
-	int x, y, t1, t2, dx, dy, xd, yd, sdx, sdy, ax, ay, ex, ey, sw, sh;
-	tColorRGBA c00, c01, c10, c11, cswap;
-	tColorRGBA *pc, *sp;
-	int gap;
+	tTransformRGBA *t = (tTransformRGBA *)data;
+	SDL_Surface *src = t->src;
+	SDL_Surface *dst = t->dst;
+	int x, y, i, n, dx, dy, xd, yd, sdx, sdy, ax, ay, sw, sh, spixelgap, right, down;
+	Uint32 *sp, *pc;
+	Uint32 c00[ROTOZOOM_CHUNK], c01[ROTOZOOM_CHUNK], c10[ROTOZOOM_CHUNK], c11[ROTOZOOM_CHUNK], out[ROTOZOOM_CHUNK];
+	Uint16 fx[ROTOZOOM_CHUNK], fy[ROTOZOOM_CHUNK];
+	int idx[ROTOZOOM_CHUNK];
 
 	/*
 	* Variable setup 
 	*/
 	xd = ((src->w - dst->w) << 15);
 	yd = ((src->h - dst->h) << 15);
-	ax = (cx << 16) - (icos * cx);
-	ay = (cy << 16) - (isin * cx);
+	ax = (t->cx << 16) - (t->icos * t->cx);
+	ay = (t->cy << 16) - (t->isin * t->cx);
 	sw = src->w - 1;
 	sh = src->h - 1;
-	pc = (tColorRGBA*) dst->pixels;
-	gap = dst->pitch - dst->w * 4;
+	spixelgap = src->pitch/4;
+	right = t->flipx ? -1 : 1;
+	down = t->flipy ? -spixelgap : spixelgap;
 
-	/*
-	* Switch between interpolating and non-interpolating code 
-	*/
-	if (smooth) {
-		for (y = 0; y < dst->h; y++) {
-			dy = cy - y;
-			sdx = (ax + (isin * dy)) + xd;
-			sdy = (ay - (icos * dy)) + yd;
-			for (x = 0; x < dst->w; x++) {
-				dx = (sdx >> 16);
-				dy = (sdy >> 16);
-				if (flipx) dx = sw - dx;
-				if (flipy) dy = sh - dy;
-				if ((dx > -1) && (dy > -1) && (dx < (src->w-1)) && (dy < (src->h-1))) {
-					sp = (tColorRGBA *)src->pixels;
-					sp += ((src->pitch/4) * dy);
-					sp += dx;
-					c00 = *sp;
-					sp += 1;
-					c01 = *sp;
-					sp += (src->pitch/4);
-					c11 = *sp;
-					sp -= 1;
-					c10 = *sp;
-					if (flipx) {
-						cswap = c00; c00=c01; c01=cswap;
-						cswap = c10; c10=c11; c11=cswap;
-					}
-					if (flipy) {
-						cswap = c00; c00=c10; c10=cswap;
-						cswap = c01; c01=c11; c11=cswap;
-					}
-					/*
-					* Interpolate colors 
-					*/
-					ex = (sdx & 0xffff);
-					ey = (sdy & 0xffff);
-					t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
-					t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
-					pc->r = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
-					t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
-					pc->g = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
-					t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
-					pc->b = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
-					t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
-					pc->a = (((t2 - t1) * ey) >> 16) + t1;
-				}
-				sdx += icos;
-				sdy += isin;
-				pc++;
-			}
-			pc = (tColorRGBA *) ((Uint8 *) pc + gap);
-		}
-	} else {
-		for (y = 0; y < dst->h; y++) {
-			dy = cy - y;
-			sdx = (ax + (isin * dy)) + xd;
-			sdy = (ay - (icos * dy)) + yd;
+	for (y = y0; y < y1; y++) {
+		dy = t->cy - y;
+		sdx = (ax + (t->isin * dy)) + xd;
+		sdy = (ay - (t->icos * dy)) + yd;
+		pc = (Uint32 *) ((Uint8 *) dst->pixels + y * dst->pitch);
+
+		if (!t->smooth) {
 			for (x = 0; x < dst->w; x++) {
 				dx = (short) (sdx >> 16);
 				dy = (short) (sdy >> 16);
-				if (flipx) dx = (src->w-1)-dx;
-				if (flipy) dy = (src->h-1)-dy;
+				if (t->flipx) dx = (src->w-1)-dx;
+				if (t->flipy) dy = (src->h-1)-dy;
 				if ((dx >= 0) && (dy >= 0) && (dx < src->w) && (dy < src->h)) {
-					sp = (tColorRGBA *) ((Uint8 *) src->pixels + src->pitch * dy);
-					sp += dx;
-					*pc = *sp;
+					pc[x] = *((Uint32 *) ((Uint8 *) src->pixels + src->pitch * dy) + dx);
 				}
-				sdx += icos;
-				sdy += isin;
-				pc++;
+				sdx += t->icos;
+				sdy += t->isin;
 			}
-			pc = (tColorRGBA *) ((Uint8 *) pc + gap);
+			continue;
+		}
+
+		/*
+		* Gather the pixels inside the source, interpolate and scatter them back 
+		*/
+		n = 0;
+		for (x = 0; x < dst->w; x++) {
+			dx = (sdx >> 16);
+			dy = (sdy >> 16);
+			if (t->flipx) dx = sw - dx;
+			if (t->flipy) dy = sh - dy;
+			if ((dx > -1) && (dy > -1) && (dx < (src->w-1)) && (dy < (src->h-1))) {
+				/* Mirroring swaps the neighbours, so start at the far corner */
+				sp = (Uint32 *) src->pixels + spixelgap * (t->flipy ? dy + 1 : dy) + (t->flipx ? dx + 1 : dx);
+				c00[n] = sp[0];
+				c01[n] = sp[right];
+				c10[n] = sp[down];
+				c11[n] = sp[down + right];
+				fx[n] = (Uint16) ((sdx & 0xffff) >> 8);
+				fy[n] = (Uint16) ((sdy & 0xffff) >> 8);
+				idx[n] = x;
+				n++;
+				if (n == ROTOZOOM_CHUNK) {
+					_interpolateRGBA(out, n, c00, c01, c10, c11, fx, fy);
+					for (i = 0; i < n; i++) {
+						pc[idx[i]] = out[i];
+					}
+					n = 0;
+				}
+			}
+			sdx += t->icos;
+			sdy += t->isin;
+		}
+		_interpolateRGBA(out, n, c00, c01, c10, c11, fx, fy);
+		for (i = 0; i < n; i++) {
+			pc[idx[i]] = out[i];
 		}
 	}
 }
 
+/*! 
+\brief Internal 32 bit rotozoomer with optional anti-aliasing.
+
+Rotates and zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface based on the control 
+parameters by scanning the destination surface and applying optionally anti-aliasing
+by bilinear interpolation.
+Assumes src and dst surfaces are of 32 bit depth.
+Assumes dst surface was allocated with the correct dimensions.
+The destination rows are split into bands processed in parallel (see rotozoomSetThreads).
+
+\param src Source surface.
+\param dst Destination surface.
+\param cx Horizontal center coordinate.
+\param cy Vertical center coordinate.
+\param isin Integer version of sine of angle.
+\param icos Integer version of cosine of angle.
+\param flipx Flag indicating horizontal mirroring should be applied.
+\param flipy Flag indicating vertical mirroring should be applied.
+\param smooth Flag indicating anti-aliasing should be used.
+*/
+void _transformSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int isin, int icos, int flipx, int flipy, int smooth)
+{
+	tTransformRGBA t;
+
+	t.src = src;
+	t.dst = dst;
+	t.cx = cx;
+	t.cy = cy;
+	t.isin = isin;
+	t.icos = icos;
+	t.flipx = flipx;
+	t.flipy = flipy;
+	t.smooth = smooth;
+	_rotozoomRunBands(_transformBandRGBA, &t, dst->h);
+}
+
 /*!
 
 \brief Rotates and zooms 8 bit palette/Y 'src' surface to 'dst' surface without smoothing.
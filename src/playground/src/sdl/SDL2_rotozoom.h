@@ -115,6 +115,14 @@ extern "C" {
 
 	SDL2_ROTOZOOM_SCOPE SDL_Surface* rotateSurface90Degrees(SDL_Surface* src, int numClockwiseTurns);
 
+	/* 
+
+	Threading
+
+	*/
+
+	SDL2_ROTOZOOM_SCOPE void rotozoomSetThreads(int threads);
+
 	/* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }